@@ -0,0 +1,113 @@
+#include "AllocationTracker.h"
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#ifdef TRACK_ALLOCATIONS
+namespace {
+	// Plain data, so using it from inside operator new never needs to allocate
+	thread_local AllocationTracker::Counts ThreadCounts;
+
+	struct ScopeTotal {
+		const char* pName;
+		AllocationTracker::Counts counts;
+		std::uint64_t iEntries;
+	};
+
+	// A fixed table, a growing one would allocate while it is counting allocations
+	const int MaxScopes = 64;
+	ScopeTotal ScopeTotals[MaxScopes];
+	int iScopeCount = 0;
+	std::mutex ScopeMutex;
+
+	void* Allocate(std::size_t iSize) {
+		ThreadCounts.iAllocations++;
+		ThreadCounts.iBytes += iSize;
+		void* pMemory = std::malloc(iSize > 0 ? iSize : 1);
+		if (!pMemory) throw std::bad_alloc();
+		return pMemory;
+	}
+
+	void Free(void* pMemory) {
+		if (!pMemory) return;
+		ThreadCounts.iFrees++;
+		std::free(pMemory);
+	}
+}
+
+// Over-aligned allocations keep the standard versions and aren't counted
+void* operator new(std::size_t iSize) { return Allocate(iSize); }
+void* operator new[](std::size_t iSize) { return Allocate(iSize); }
+void* operator new(std::size_t iSize, const std::nothrow_t&) noexcept {
+	try { return Allocate(iSize); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t iSize, const std::nothrow_t&) noexcept {
+	try { return Allocate(iSize); } catch (...) { return nullptr; }
+}
+void operator delete(void* pMemory) noexcept { Free(pMemory); }
+void operator delete[](void* pMemory) noexcept { Free(pMemory); }
+void operator delete(void* pMemory, std::size_t) noexcept { Free(pMemory); }
+void operator delete[](void* pMemory, std::size_t) noexcept { Free(pMemory); }
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept { Free(pMemory); }
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept { Free(pMemory); }
+
+bool AllocationTracker::IsEnabled() {
+	return true;
+}
+
+AllocationTracker::Counts AllocationTracker::GetThreadCounts() {
+	return ThreadCounts;
+}
+
+AllocationTracker::Scope::Scope(const char* pName)
+	: m_pName(pName)
+	, m_Start(ThreadCounts)
+{}
+
+AllocationTracker::Scope::~Scope() {
+	const Counts counts = ThreadCounts.Since(m_Start);
+
+	std::lock_guard<std::mutex> lock(ScopeMutex);
+	for (int i = 0; i < iScopeCount; i++) {
+		if (std::strcmp(ScopeTotals[i].pName, m_pName) != 0) continue;
+		ScopeTotals[i].counts.iAllocations += counts.iAllocations;
+		ScopeTotals[i].counts.iBytes += counts.iBytes;
+		ScopeTotals[i].counts.iFrees += counts.iFrees;
+		ScopeTotals[i].iEntries++;
+		return;
+	}
+	if (iScopeCount < MaxScopes) {
+		ScopeTotals[iScopeCount++] = { m_pName, counts, 1 };
+	}
+}
+
+void AllocationTracker::WriteScopeReport(std::ostream& rStream) {
+	std::lock_guard<std::mutex> lock(ScopeMutex);
+	rStream << "  scope        entries   allocations   KB   allocations per entry\n";
+	for (int i = 0; i < iScopeCount; i++) {
+		const ScopeTotal& rTotal = ScopeTotals[i];
+		rStream << "  " << rTotal.pName << "  " << rTotal.iEntries << "  " << rTotal.counts.iAllocations << "  " << rTotal.counts.iBytes / 1024
+			<< "  " << static_cast<double>(rTotal.counts.iAllocations) / rTotal.iEntries << "\n";
+	}
+}
+
+void AllocationTracker::ResetScopes() {
+	std::lock_guard<std::mutex> lock(ScopeMutex);
+	iScopeCount = 0;
+}
+#else
+bool AllocationTracker::IsEnabled() {
+	return false;
+}
+
+AllocationTracker::Counts AllocationTracker::GetThreadCounts() {
+	return Counts();
+}
+
+void AllocationTracker::WriteScopeReport(std::ostream& rStream) {
+	rStream << "  allocation tracking is off, build with TRACK_ALLOCATIONS defined to see scopes\n";
+}
+
+void AllocationTracker::ResetScopes() {}
+#endif
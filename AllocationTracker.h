@@ -0,0 +1,50 @@
+#ifndef ALLOCATIONTRACKER
+#define ALLOCATIONTRACKER
+
+#include <cstdint>
+#include <iostream>
+
+// Counts heap allocations made through the global operator new, per thread and per named scope.
+// Only built in when TRACK_ALLOCATIONS is defined, since it replaces operator new for the whole
+// program. Without it every count stays at zero and scopes compile to nothing.
+class AllocationTracker {
+public:
+	struct Counts {
+		std::uint64_t iAllocations = 0;
+		std::uint64_t iBytes = 0;
+		std::uint64_t iFrees = 0;
+
+		Counts Since(const Counts& rEarlier) const {
+			Counts counts;
+			counts.iAllocations = iAllocations - rEarlier.iAllocations;
+			counts.iBytes = iBytes - rEarlier.iBytes;
+			counts.iFrees = iFrees - rEarlier.iFrees;
+			return counts;
+		}
+	};
+
+	static bool IsEnabled();
+	// Everything the calling thread has allocated so far
+	static Counts GetThreadCounts();
+
+	// Adds whatever the calling thread allocates while it is alive to a total kept under its name.
+	// The name has to last as long as the program, like a string literal.
+	class Scope {
+	public:
+#ifdef TRACK_ALLOCATIONS
+		explicit Scope(const char* pName);
+		~Scope();
+	private:
+		const char* m_pName;
+		Counts m_Start;
+#else
+		explicit Scope(const char*) {}
+#endif
+	};
+
+	// Totals for every scope since the last reset, one line each
+	static void WriteScopeReport(std::ostream& rStream);
+	static void ResetScopes();
+};
+
+#endif // !ALLOCATIONTRACKER
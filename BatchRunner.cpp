@@ -0,0 +1,101 @@
+#include "BatchRunner.h"
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+
+BatchRunner::BatchRunner(float fSimulatedSeconds, float fTickSeconds)
+	: m_fSimulatedSeconds(fSimulatedSeconds)
+	, m_fTickSeconds(fTickSeconds)
+{}
+
+std::vector<BatchRunner::Job> BatchRunner::MakeRandomJobs(int iJobCount, int iTowersPerJob, unsigned int uFirstSeed) {
+	const float fLevelWidth = Game::LaneLevelColumns * 160.0f;
+	const float fLevelHeight = Game::LaneLevelRows * 160.0f;
+
+	std::vector<Job> jobs(iJobCount);
+	for (int i = 0; i < iJobCount; i++) {
+		Job& rJob = jobs[i];
+		rJob.uSeed = uFirstSeed + i;
+
+		// The layout comes from its own generator, so the match seed only drives the match
+		std::mt19937 layoutRng(rJob.uSeed * 2654435761u);
+		std::uniform_real_distribution<float> xDistribution(0.0f, fLevelWidth);
+		std::uniform_real_distribution<float> yDistribution(0.0f, fLevelHeight);
+		for (int iTower = 0; iTower < iTowersPerJob; iTower++) {
+			rJob.TowerPositions.push_back(sf::Vector2f(xDistribution(layoutRng), yDistribution(layoutRng)));
+		}
+	}
+	return jobs;
+}
+
+std::vector<BatchRunner::Result> BatchRunner::Run(const std::vector<Job>& rJobs, int iThreads) const {
+	if (iThreads <= 0) {
+		iThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	iThreads = std::min(iThreads, static_cast<int>(rJobs.size()));
+
+	std::vector<Result> results(rJobs.size());
+	std::atomic<int> iNextJob(0);
+
+	// Every thread keeps taking the next job until none are left. Each match has its own Game,
+	// so the threads share nothing but the job counter.
+	auto worker = [&]() {
+		for (int iJob = iNextJob++; iJob < static_cast<int>(rJobs.size()); iJob = iNextJob++) {
+			const Job& rJob = rJobs[iJob];
+			Game game(true, rJob.uSeed);
+			results[iJob].uSeed = rJob.uSeed;
+			results[iJob].match = game.SimulateMatch(rJob.TowerPositions, m_fSimulatedSeconds, m_fTickSeconds);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < iThreads; i++) {
+		threads.emplace_back(worker);
+	}
+	for (std::thread& rThread : threads) {
+		rThread.join();
+	}
+	return results;
+}
+
+void BatchRunner::PrintSummary(const std::vector<Result>& rResults, std::ostream& rStream) {
+	if (rResults.empty()) {
+		rStream << "No matches played\n";
+		return;
+	}
+
+	int iSurvived = 0;
+	float fTotalSurvivedSeconds = 0.0f;
+	double fTotalGoldEarned = 0.0;
+	double fTotalKilled = 0.0;
+	double fTotalLeaked = 0.0;
+	int iMinGold = rResults[0].match.iGoldEarned;
+	int iMaxGold = rResults[0].match.iGoldEarned;
+	const Result* pBest = &rResults[0];
+
+	for (const Result& rResult : rResults) {
+		const Game::MatchResult& rMatch = rResult.match;
+		if (rMatch.bSurvived) iSurvived++;
+		fTotalSurvivedSeconds += rMatch.fSurvivedSeconds;
+		fTotalGoldEarned += rMatch.iGoldEarned;
+		fTotalKilled += rMatch.iEnemiesKilled;
+		fTotalLeaked += rMatch.iEnemiesLeaked;
+		iMinGold = std::min(iMinGold, rMatch.iGoldEarned);
+		iMaxGold = std::max(iMaxGold, rMatch.iGoldEarned);
+
+		if (rMatch.iGoldEarned > pBest -> match.iGoldEarned) {
+			pBest = &rResult;
+		}
+	}
+
+	const double fCount = static_cast<double>(rResults.size());
+	rStream << "Batch of " << rResults.size() << " matches\n";
+	rStream << "  survived: " << iSurvived << " (" << 100.0 * iSurvived / fCount << "%)\n";
+	rStream << "  average seconds survived: " << fTotalSurvivedSeconds / fCount << "\n";
+	rStream << "  average gold earned: " << fTotalGoldEarned / fCount << " (min " << iMinGold << ", max " << iMaxGold << ")\n";
+	rStream << "  average enemies killed: " << fTotalKilled / fCount << "\n";
+	rStream << "  average enemies leaked: " << fTotalLeaked / fCount << "\n";
+	rStream << "  best seed: " << pBest -> uSeed << " with " << pBest -> match.iTowersPlaced << " towers and "
+		<< pBest -> match.iGoldEarned << " gold\n";
+}
@@ -0,0 +1,36 @@
+#ifndef BATCHRUNNER
+#define BATCHRUNNER
+
+#include "game.h"
+#include <vector>
+#include <iostream>
+
+// Plays many headless matches in parallel, for balance tuning
+class BatchRunner {
+public:
+	struct Job {
+		unsigned int uSeed;
+		std::vector<sf::Vector2f> TowerPositions;
+	};
+
+	struct Result {
+		unsigned int uSeed;
+		Game::MatchResult match;
+	};
+
+	BatchRunner(float fSimulatedSeconds, float fTickSeconds);
+
+	// Random tower layouts anywhere on the lane level, invalid spots get rejected when placing
+	static std::vector<Job> MakeRandomJobs(int iJobCount, int iTowersPerJob, unsigned int uFirstSeed);
+
+	// Spreads the jobs over iThreads threads, or one per core when 0
+	std::vector<Result> Run(const std::vector<Job>& rJobs, int iThreads = 0) const;
+
+	static void PrintSummary(const std::vector<Result>& rResults, std::ostream& rStream);
+
+private:
+	float m_fSimulatedSeconds;
+	float m_fTickSeconds;
+};
+
+#endif // !BATCHRUNNER
@@ -0,0 +1,38 @@
+#include "CellIndexMap.h"
+#include <algorithm>
+
+CellIndexMap::CellIndexMap()
+	: m_iWidth(0)
+	, m_iHeight(0)
+{}
+
+int CellIndexMap::Get(const sf::Vector2i& vCell) const {
+	if (vCell.x < 0 || vCell.y < 0 || vCell.x >= m_iWidth || vCell.y >= m_iHeight) return -1;
+	return m_Indices[vCell.y * m_iWidth + vCell.x];
+}
+
+void CellIndexMap::Set(const sf::Vector2i& vCell, int iIndex) {
+	if (vCell.x < 0 || vCell.y < 0) return;
+
+	if (vCell.x >= m_iWidth || vCell.y >= m_iHeight) {
+		if (iIndex < 0) return; // Outside the map is already empty
+
+		// Grow, copying the old rows into the wider layout
+		const int iNewWidth = std::max(m_iWidth, vCell.x + 1);
+		const int iNewHeight = std::max(m_iHeight, vCell.y + 1);
+		std::vector<int> newIndices(iNewWidth * iNewHeight, -1);
+		for (int y = 0; y < m_iHeight; y++) {
+			for (int x = 0; x < m_iWidth; x++) {
+				newIndices[y * iNewWidth + x] = m_Indices[y * m_iWidth + x];
+			}
+		}
+		m_Indices.swap(newIndices);
+		m_iWidth = iNewWidth;
+		m_iHeight = iNewHeight;
+	}
+	m_Indices[vCell.y * m_iWidth + vCell.x] = iIndex;
+}
+
+void CellIndexMap::Clear() {
+	m_Indices.assign(m_Indices.size(), -1);
+}
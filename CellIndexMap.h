@@ -0,0 +1,26 @@
+#ifndef CELLINDEXMAP
+#define CELLINDEXMAP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Which entry of a list sits in each grid cell, so the list can be edited by cell without a search.
+// Cells left of or above the origin are never held.
+class CellIndexMap {
+public:
+	CellIndexMap();
+
+	// -1 when nothing is there
+	int Get(const sf::Vector2i& vCell) const;
+	// -1 empties the cell. Ignored for cells left of or above the origin.
+	void Set(const sf::Vector2i& vCell, int iIndex);
+	void Clear();
+
+private:
+	// One entry per cell, grown to fit the furthest cell set
+	std::vector<int> m_Indices;
+	int m_iWidth;
+	int m_iHeight;
+};
+
+#endif // !CELLINDEXMAP
@@ -0,0 +1,41 @@
+#include "DamageEvents.h"
+#include <algorithm>
+#include <functional>
+
+void DamageEventBuffer::AddDamage(Entity& rTarget, int iDamage, const sf::Vector2f& vKnockback) {
+	DamageEvent damageEvent;
+	damageEvent.pTarget = &rTarget;
+	damageEvent.iDamage = iDamage;
+	damageEvent.vKnockback = vKnockback;
+	m_Events.push_back(damageEvent);
+}
+
+void DamageEventBuffer::AddSplash(const sf::Vector2f& vCenter, float fRadius, int iDamage, float fKnockback) {
+	SplashEvent splashEvent;
+	splashEvent.vCenter = vCenter;
+	splashEvent.fRadius = fRadius;
+	splashEvent.iDamage = iDamage;
+	splashEvent.fKnockback = fKnockback;
+	m_Splashes.push_back(splashEvent);
+}
+
+void DamageEventBuffer::MergeByTarget() {
+	if (m_Events.size() < 2) return;
+
+	// Group hits on the same target next to each other
+	std::sort(m_Events.begin(), m_Events.end(), [](const DamageEvent& a, const DamageEvent& b) {
+		return std::less<Entity*>()(a.pTarget, b.pTarget);
+	});
+
+	size_t iMerged = 0;
+	for (size_t i = 1; i < m_Events.size(); i++) {
+		DamageEvent& rMergedEvent = m_Events[iMerged];
+		if (m_Events[i].pTarget == rMergedEvent.pTarget) {
+			rMergedEvent.iDamage += m_Events[i].iDamage;
+			rMergedEvent.vKnockback += m_Events[i].vKnockback;
+		} else {
+			m_Events[++iMerged] = m_Events[i];
+		}
+	}
+	m_Events.resize(iMerged + 1);
+}
@@ -0,0 +1,45 @@
+#ifndef DAMAGEEVENTS
+#define DAMAGEEVENTS
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+class Entity;
+
+// A hit recorded while physics runs. Nothing is applied to the target until the end of the tick.
+struct DamageEvent {
+	Entity* pTarget;
+	int iDamage;
+	sf::Vector2f vKnockback;
+};
+
+// An explosion recorded while physics runs. It becomes one DamageEvent per enemy it reaches
+// when the tick's events are applied, so an impact costs only the enemies near it.
+struct SplashEvent {
+	sf::Vector2f vCenter;
+	float fRadius;
+	int iDamage;
+	float fKnockback; // Pushes every enemy caught straight away from the centre
+};
+
+// Collects the tick's hits so health, deaths and damage text are handled in one batch
+class DamageEventBuffer {
+public:
+	void AddDamage(Entity& rTarget, int iDamage, const sf::Vector2f& vKnockback);
+	void AddSplash(const sf::Vector2f& vCenter, float fRadius, int iDamage, float fKnockback);
+
+	// Combines every hit on the same target into one event
+	void MergeByTarget();
+
+	void Clear() { m_Events.clear(); m_Splashes.clear(); }
+	bool IsEmpty() const { return m_Events.empty() && m_Splashes.empty(); }
+	const std::vector<DamageEvent>& GetEvents() const { return m_Events; }
+	const std::vector<SplashEvent>& GetSplashes() const { return m_Splashes; }
+	void ClearSplashes() { m_Splashes.clear(); }
+
+private:
+	std::vector<DamageEvent> m_Events;
+	std::vector<SplashEvent> m_Splashes;
+};
+
+#endif // !DAMAGEEVENTS
@@ -1,59 +1,60 @@
-#include "DamageTextManager.h"
-
-DamageTextManager DamageTextManager::m_Instance;
-
-DamageTextManager::DamageTextManager() {
-	m_Font.loadFromFile("Fonts/Kreon-Medium.ttf");
-}
-
-DamageTextManager::~DamageTextManager() {
-
-}
-
-void DamageTextManager::Update(sf::Time& rDeltaTime) {
-	const int iCount = m_DamageTextList.size();
-	for (int i = 0; i < iCount; i++) {
-		DamageText damageText = m_DamageTextList.front();
-		m_DamageTextList.pop_front();
-		damageText.m_fRemainingLifeSeconds -= rDeltaTime.asSeconds();
-
-		if (damageText.m_fRemainingLifeSeconds > 0.0f) {
-			//Fade out the damage text over time
-			float fPercentageThroughLife = damageText.m_fRemainingLifeSeconds / m_fDamageTextLifeInSeconds;
-			
-			sf::Color color = damageText.m_Text.getFillColor();
-			color.a = static_cast <sf::Uint8> (255.0f * fPercentageThroughLife);
-
-			sf::Color OutlineColor = damageText.m_Text.getOutlineColor();
-			OutlineColor.a = static_cast <sf::Uint8> (255.0f * fPercentageThroughLife);
-
-			damageText.m_Text.setFillColor(color);
-			damageText.m_Text.setOutlineColor(OutlineColor);
-
-			m_DamageTextList.push_back(damageText);
-		}
-	}
-}
-
-void DamageTextManager::Draw(sf::RenderTarget& rRenderTarget) const {
-	for (const DamageText& damageText : m_DamageTextList) {
-		rRenderTarget.draw(damageText.m_Text);
-	}
-}
-
-void DamageTextManager::AddDamageText(int damage, const sf::Vector2f& pos) {
-	sf::Text text;
-	text.setFont(m_Font);
-	text.setString(std::to_string(damage));
-	text.setCharacterSize(36);
-	text.setOutlineColor(sf::Color::Black);
-	text.setOutlineThickness(2.0f);
-	text.setPosition(pos);
-	text.setOrigin(text.getLocalBounds().width / 2.0f, text.getLocalBounds().height / 2.0f);
-	
-	DamageText damageText;
-	damageText.m_Text = text;
-	damageText.m_fRemainingLifeSeconds = m_fDamageTextLifeInSeconds;
-
-	m_DamageTextList.push_back(damageText);
-}
\ No newline at end of file
+#include "DamageTextManager.h"
+
+DamageTextManager::DamageTextManager()
+	: m_iTextDamage(-1)
+{
+	m_DamageTextList.reserve(256);
+	m_Text.setCharacterSize(36);
+	m_Text.setOutlineThickness(2.0f);
+}
+
+DamageTextManager::~DamageTextManager() {
+
+}
+
+void DamageTextManager::LoadFont(const std::string& rFileName) {
+	m_Font.loadFromFile(rFileName);
+	m_Text.setFont(m_Font);
+}
+
+void DamageTextManager::Update(sf::Time& rDeltaTime) {
+	// Drop expired numbers in place, keeping the rest in the order they were added
+	int iKept = 0;
+	for (int i = 0; i < static_cast<int>(m_DamageTextList.size()); i++) {
+		DamageText& damageText = m_DamageTextList[i];
+		damageText.m_fRemainingLifeSeconds -= rDeltaTime.asSeconds();
+
+		if (damageText.m_fRemainingLifeSeconds > 0.0f) {
+			m_DamageTextList[iKept++] = damageText;
+		}
+	}
+	m_DamageTextList.resize(iKept);
+}
+
+void DamageTextManager::Draw(sf::RenderTarget& rRenderTarget, const std::vector<DamageText>& rDamageTexts) const {
+	for (const DamageText& damageText : rDamageTexts) {
+		if (damageText.m_iDamage != m_iTextDamage) {
+			m_Text.setString(std::to_string(damageText.m_iDamage));
+			m_Text.setOrigin(m_Text.getLocalBounds().width / 2.0f, m_Text.getLocalBounds().height / 2.0f);
+			m_iTextDamage = damageText.m_iDamage;
+		}
+
+		//Fade out the damage text over time
+		float fPercentageThroughLife = damageText.m_fRemainingLifeSeconds / m_fDamageTextLifeInSeconds;
+		const sf::Uint8 iAlpha = static_cast <sf::Uint8> (255.0f * fPercentageThroughLife);
+
+		m_Text.setFillColor(sf::Color(255, 255, 255, iAlpha));
+		m_Text.setOutlineColor(sf::Color(0, 0, 0, iAlpha));
+		m_Text.setPosition(damageText.m_vPosition);
+		rRenderTarget.draw(m_Text);
+	}
+}
+
+void DamageTextManager::AddDamageText(int damage, const sf::Vector2f& pos) {
+	DamageText damageText;
+	damageText.m_iDamage = damage;
+	damageText.m_vPosition = pos;
+	damageText.m_fRemainingLifeSeconds = m_fDamageTextLifeInSeconds;
+
+	m_DamageTextList.push_back(damageText);
+}
@@ -1,46 +1,50 @@
-#ifndef DAMAGETEXTMANAGER
-#define DAMAGETEXTMANAGER
-
-#include <SFML/Graphics.hpp>
-#include <SFML/System/Time.hpp>;
-#include <vector>
-#include <deque>
-#include <iostream>
-#include <string>
-
-namespace sf {
-	class Text;
-	class RenderTarget;
-	class Time;
-}
-
-class DamageTextManager {
-private:
-	DamageTextManager();
-	~DamageTextManager();
-public:
-	void Update(sf::Time& rDeltaTime);
-	void Draw(sf::RenderTarget& rRenderTarget) const;
-
-	void AddDamageText(int damage, const sf::Vector2f& pos);
-
-	static const DamageTextManager& getInstanceConst() {
-		return m_Instance;
-	}
-
-	static DamageTextManager& getInstanceNonConst() {
-		return m_Instance;
-	}
-private:
-	static DamageTextManager m_Instance;
-	static float constexpr m_fDamageTextLifeInSeconds = 1.0f;
-
-	struct DamageText {
-		sf::Text m_Text;
-		float m_fRemainingLifeSeconds;
-	};
-	sf::Font m_Font;
-	std::deque<DamageText> m_DamageTextList;
-};
-
-#endif
\ No newline at end of file
+#ifndef DAMAGETEXTMANAGER
+#define DAMAGETEXTMANAGER
+
+#include <SFML/Graphics.hpp>
+#include <SFML/System/Time.hpp>;
+#include <vector>
+#include <iostream>
+#include <string>
+
+namespace sf {
+	class Text;
+	class RenderTarget;
+	class Time;
+}
+
+class DamageTextManager {
+public:
+	DamageTextManager();
+	~DamageTextManager();
+
+	void LoadFont(const std::string& rFileName);
+
+	// Only what changes between numbers is stored, the text itself is built when drawing
+	struct DamageText {
+		int m_iDamage;
+		sf::Vector2f m_vPosition;
+		float m_fRemainingLifeSeconds;
+	};
+
+	// Simulation side: ages and collects the numbers
+	void Update(sf::Time& rDeltaTime);
+	void AddDamageText(int damage, const sf::Vector2f& pos);
+	const std::vector<DamageText>& GetDamageTexts() const { return m_DamageTextList; }
+	void SetDamageTexts(const DamageText* pDamageTexts, std::size_t iCount) { m_DamageTextList.assign(pDamageTexts, pDamageTexts + iCount); }
+
+	// Render side: draws numbers copied out of the simulation. Only touches the font and text,
+	// so it can run on the render thread while the simulation keeps adding numbers.
+	void Draw(sf::RenderTarget& rRenderTarget, const std::vector<DamageText>& rDamageTexts) const;
+private:
+	static float constexpr m_fDamageTextLifeInSeconds = 1.0f;
+
+	sf::Font m_Font;
+	std::vector<DamageText> m_DamageTextList;
+
+	// One text reused for every number, its string is only rebuilt when the damage changes
+	mutable sf::Text m_Text;
+	mutable int m_iTextDamage;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "EditHistory.h"
+
+EditHistory::EditHistory()
+	: m_iAppliedStrokes(0)
+	, m_bStrokeOpen(false)
+{}
+
+void EditHistory::BeginStroke() {
+	if (m_bStrokeOpen) return;
+
+	// A new stroke throws away anything that was undone
+	if (m_iAppliedStrokes < GetStrokeCount()) {
+		m_Edits.resize(m_StrokeStarts[m_iAppliedStrokes]);
+		m_StrokeStarts.resize(m_iAppliedStrokes);
+	}
+	m_StrokeStarts.push_back(static_cast<int>(m_Edits.size()));
+	m_iAppliedStrokes++;
+	m_bStrokeOpen = true;
+}
+
+void EditHistory::Record(const TileEdit& rEdit) {
+	if (!m_bStrokeOpen) return;
+	m_Edits.push_back(rEdit);
+}
+
+void EditHistory::EndStroke() {
+	if (!m_bStrokeOpen) return;
+	m_bStrokeOpen = false;
+
+	if (m_StrokeStarts.back() == static_cast<int>(m_Edits.size())) {
+		m_StrokeStarts.pop_back();
+		m_iAppliedStrokes--;
+	}
+}
+
+bool EditHistory::Undo(const TileEdit*& rpBegin, const TileEdit*& rpEnd) {
+	EndStroke();
+	if (m_iAppliedStrokes == 0) return false;
+
+	m_iAppliedStrokes--;
+	rpBegin = m_Edits.data() + m_StrokeStarts[m_iAppliedStrokes];
+	rpEnd = m_Edits.data() + GetStrokeEnd(m_iAppliedStrokes);
+	return true;
+}
+
+bool EditHistory::Redo(const TileEdit*& rpBegin, const TileEdit*& rpEnd) {
+	EndStroke();
+	if (m_iAppliedStrokes == GetStrokeCount()) return false;
+
+	rpBegin = m_Edits.data() + m_StrokeStarts[m_iAppliedStrokes];
+	rpEnd = m_Edits.data() + GetStrokeEnd(m_iAppliedStrokes);
+	m_iAppliedStrokes++;
+	return true;
+}
+
+void EditHistory::Clear() {
+	m_Edits.clear();
+	m_StrokeStarts.clear();
+	m_iAppliedStrokes = 0;
+	m_bStrokeOpen = false;
+}
+
+int EditHistory::GetStrokeEnd(int iStroke) const {
+	return iStroke + 1 < GetStrokeCount() ? m_StrokeStarts[iStroke + 1] : static_cast<int>(m_Edits.size());
+}
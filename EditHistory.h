@@ -0,0 +1,51 @@
+#ifndef EDITHISTORY
+#define EDITHISTORY
+
+#include <vector>
+#include <cstdint>
+
+// Undo and redo for the level editor. Every tile change is logged as a small delta, and the
+// deltas made while a mouse button is held are grouped into one stroke. Undoing a stroke replays
+// its deltas backwards, so it costs as much as the stroke did, not as much as the map.
+class EditHistory {
+public:
+	// One tile change, with enough to apply it either way
+	struct TileEdit {
+		std::int8_t iTileType; // Which tile list, a TileOptions::TileType
+		std::int8_t iOldOption; // Tile option that was there, -1 when there was no tile
+		std::int8_t iNewOption; // Tile option put there, -1 when the tile was removed
+		std::int16_t iCellX;
+		std::int16_t iCellY;
+		std::int32_t iListIndex; // Where the tile sits in its list
+		// Removing a tile moves the list's last tile into the hole, this is where it came from.
+		// -1 when the removed tile was the last one, or the edit removes nothing.
+		std::int32_t iMovedIndex;
+	};
+
+	EditHistory();
+
+	void BeginStroke();
+	// Ignored unless a stroke is open
+	void Record(const TileEdit& rEdit);
+	// A stroke that changed nothing is dropped
+	void EndStroke();
+	bool IsStrokeOpen() const { return m_bStrokeOpen; }
+
+	// The edits of the stroke to undo or redo, false if there is none.
+	// Undo edits must be applied from the back, redo edits from the front.
+	bool Undo(const TileEdit*& rpBegin, const TileEdit*& rpEnd);
+	bool Redo(const TileEdit*& rpBegin, const TileEdit*& rpEnd);
+
+	void Clear();
+
+private:
+	int GetStrokeCount() const { return static_cast<int>(m_StrokeStarts.size()); }
+	int GetStrokeEnd(int iStroke) const;
+
+	std::vector<TileEdit> m_Edits; // Every stroke's edits, one stroke after another
+	std::vector<int> m_StrokeStarts; // Index of each stroke's first edit
+	int m_iAppliedStrokes; // Strokes before this are on the map, the rest can be redone
+	bool m_bStrokeOpen;
+};
+
+#endif // !EDITHISTORY
@@ -1,34 +1,121 @@
-#include "Entity.h"
-#include "MathHelpers.h"
-#include "DamageTextManager.h"
-
-Entity::Entity(PhysicsData::Type ePhysicsType)
-	: m_fAttackTimer(1.0f)
-	, m_bDeletionRequested(false)
-	, m_fAxeTimer(3.0f)
-{
-	m_PhysicsData.m_eType = ePhysicsType;
-}
-
-void Entity::OnCollision(Entity& pOtherEntity) {
-	if (pOtherEntity.GetPhysicsData().IsInAnyLayer(PhysicsData::Layer::Enemy)) {
-		//If we are a projectile
-		if (GetPhysicsData().IsInAnyLayer(PhysicsData::Layer::Projectile)) {
-			sf::Vector2f direction = pOtherEntity.GetPosition() - GetPosition();
-			direction = MathHelpers::normalize(direction);
-			pOtherEntity.GetPhysicsDataNonConst().AddImpulse(direction * 80.0f);
-
-			//Projectile hit the enemy
-			pOtherEntity.DealDamage(1);
-			m_bDeletionRequested = true;
-		}
-	}
-}
-
-void Entity::DealDamage(int damage) {
-	m_iHealth -= damage;
-	DamageTextManager::getInstanceNonConst().AddDamageText(damage, GetPosition());
-	if (m_iHealth <= 0) {
-		m_bDeletionRequested = true;
-	}
-}
+#include "Entity.h"
+#include "MathHelpers.h"
+#include "DamageEvents.h"
+#include <cstring>
+
+Entity::Prototype::Prototype(PhysicsData::Type ePhysicsType)
+	: m_iHealth(0)
+{
+	m_PhysicsData.m_eType = ePhysicsType;
+	m_PhysicsData.m_eShape = PhysicsData::Shape::Circle;
+	m_PhysicsData.m_iMyLayer = 0;
+	m_PhysicsData.m_iLayersToIgnore = 0;
+	m_PhysicsData.m_iInteractionMask = 0;
+	m_PhysicsData.m_fRadius = 0.0f;
+	m_PhysicsData.m_fWidth = 0.0f;
+	m_PhysicsData.m_fHeight = 0.0f;
+}
+
+Entity::Entity(const Prototype& rPrototype)
+	: m_pPrototype(&rPrototype)
+	, m_vPosition(0.0f, 0.0f)
+	, m_fRotation(0.0f)
+	, m_Color(rPrototype.m_Sprite.getColor())
+	, m_vVelocity(0.0f, 0.0f)
+	, m_vImpulse(0.0f, 0.0f)
+	, m_bDeletionRequested(false)
+	, m_iExitIndex(0)
+	, m_iHealth(rPrototype.m_iHealth)
+	, m_iTimerDueTick(0)
+	, m_iTimerHandle(-1)
+	, m_eTargetingMode(TargetingMode::First)
+	, m_fSplashRadius(0.0f)
+	, m_iSteeredCell(-1)
+	, m_vWaypoint(0.0f, 0.0f)
+{
+}
+
+Entity::State Entity::GetState() const {
+	// Zero the padding too, so equal entities give equal bytes
+	State state;
+	std::memset(static_cast<void*>(&state), 0, sizeof(state));
+	state.vPosition = m_vPosition;
+	state.fRotation = m_fRotation;
+	state.color = m_Color;
+	state.vVelocity = m_vVelocity;
+	state.vImpulse = m_vImpulse;
+	state.iExitIndex = m_iExitIndex;
+	state.iHealth = m_iHealth;
+	state.iTimerDueTick = m_iTimerDueTick;
+	state.fSplashRadius = m_fSplashRadius;
+	state.iTargetingMode = static_cast<int>(m_eTargetingMode);
+	state.iSteeredCell = m_iSteeredCell;
+	state.vWaypoint = m_vWaypoint;
+	state.bDeletionRequested = m_bDeletionRequested;
+	return state;
+}
+
+void Entity::SetState(const State& rState) {
+	m_vPosition = rState.vPosition;
+	m_fRotation = rState.fRotation;
+	m_Color = rState.color;
+	m_vVelocity = rState.vVelocity;
+	m_vImpulse = rState.vImpulse;
+	m_iExitIndex = rState.iExitIndex;
+	m_iHealth = rState.iHealth;
+	m_iTimerDueTick = rState.iTimerDueTick;
+	m_fSplashRadius = rState.fSplashRadius;
+	m_eTargetingMode = static_cast<TargetingMode>(rState.iTargetingMode);
+	m_iSteeredCell = rState.iSteeredCell;
+	m_vWaypoint = rState.vWaypoint;
+	m_bDeletionRequested = rState.bDeletionRequested;
+}
+
+void Entity::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+	DrawAppearance(target, states, *m_pPrototype, m_vPosition, m_fRotation, m_Color);
+}
+
+void Entity::DrawAppearance(sf::RenderTarget& target, sf::RenderStates states, const Prototype& rPrototype,
+	const sf::Vector2f& vPosition, float fRotation, const sf::Color& color) {
+	states.transform.translate(vPosition);
+	states.transform.rotate(fRotation);
+
+	const sf::Sprite& rSprite = rPrototype.m_Sprite;
+	if (color == rSprite.getColor()) {
+		target.draw(rSprite, states);
+		return;
+	}
+
+	// Tinted entities are rare (the tower placement preview), they get their own copy
+	sf::Sprite tintedSprite = rSprite;
+	tintedSprite.setColor(color);
+	target.draw(tintedSprite, states);
+}
+
+void Entity::OnCollision(Entity& pOtherEntity, DamageEventBuffer& rDamageEvents) {
+	if (pOtherEntity.GetPhysicsData().IsInAnyLayer(PhysicsData::Layer::Enemy)) {
+		//If we are a projectile
+		if (GetPhysicsData().IsInAnyLayer(PhysicsData::Layer::Projectile)) {
+			sf::Vector2f direction = pOtherEntity.GetPosition() - GetPosition();
+			direction = MathHelpers::normalize(direction);
+
+			//Projectile hit the enemy
+			if (m_fSplashRadius > 0.0f) {
+				// Explodes once, however many enemies it touched on the way in
+				if (!m_bDeletionRequested) {
+					rDamageEvents.AddSplash(GetPosition(), m_fSplashRadius, 1, 80.0f);
+				}
+			} else {
+				rDamageEvents.AddDamage(pOtherEntity, 1, direction * 80.0f);
+			}
+			m_bDeletionRequested = true;
+		}
+	}
+}
+
+void Entity::DealDamage(int damage) {
+	m_iHealth -= damage;
+	if (m_iHealth <= 0) {
+		m_bDeletionRequested = true;
+	}
+}
@@ -1,224 +1,286 @@
-#pragma once
-#include <SFML/Graphics.hpp>
-#include <vector>
-using namespace std;
-#ifndef ENTITY_H	
-#define ENTITY_H
-
-class Entity : public sf::Drawable
-{
-public:
-	struct PhysicsData {
-		PhysicsData() {
-			m_vImpulse = sf::Vector2f(0.0f, 0.0f);
-		}
-
-		enum Layer {
-			Enemy = 1, //0b0001
-			Tower = 2, //0b0010
-			Projectile = 4 // 0b0100
-		};
-		enum class Shape {
-			Circle,
-			Rectangle
-		};
-
-		enum class Type {
-			Static,
-			Dynamic
-		};
-		Shape m_eShape;
-		Type m_eType;
-
-		void setLayers(int layers) {
-			m_iMyLayer = layers;
-		}
-
-		void setLayersToIgnore(int layers) {
-			m_iLayersToIgnore = layers;
-		}
-
-		int getLayersToIgnore() const {
-			return m_iLayersToIgnore;
-		}
-
-		bool IsInAnyLayer(int layer) const {
-			return (m_iMyLayer & layer) != 0;
-		}
-
-		void ClearCollisions() {
-			m_EntitiesThatCollidedWithAlready.clear();
-		}
-
-		bool HasCollidedThisUpdate(Entity* pOtherEntity) const {
-			for (Entity* pEntity : m_EntitiesThatCollidedWithAlready) {
-				if (pEntity == pOtherEntity) {
-					return true;
-				}
-			}
-			return false;
-		}
-
-		void AddEntityCollision(Entity* pOtherEntity) {
-			m_EntitiesThatCollidedWithAlready.push_back(pOtherEntity);
-		}
-
-		void ClearImpulse() {
-			m_vImpulse = sf::Vector2f(0.0f, 0.0f);
-		}
-
-		void AddImpulse(const sf::Vector2f& impulse) {
-			m_vImpulse += impulse;
-		}
-
-		int m_iMyLayer;
-		int m_iLayersToIgnore;
-
-		float m_fRadius; // For Circle shape
-		float m_fWidth; // For Rectangle shape
-		float m_fHeight; // For Rectangle shape
-
-		sf::Vector2f m_vVelocity;
-		sf::Vector2f m_vImpulse;
-
-		vector<Entity*> m_IgnoredEntities; // Entities to ignore for collision
-		vector<Entity*> m_EntitiesToIgnore;
-		vector<Entity*> m_EntitiesThatCollidedWithAlready;
-	};
-	
-	Entity(PhysicsData::Type ePhysicsType);
-	~Entity() {};
-
-	void setCirclePhysics(float radius) {
-		m_PhysicsData.m_eShape = PhysicsData::Shape::Circle;
-		m_PhysicsData.m_fRadius = radius;
-	}
-
-	void setRectanglePhysics(float width, float height) {
-		m_PhysicsData.m_eShape = PhysicsData::Shape::Rectangle;
-		m_PhysicsData.m_fWidth = width;
-		m_PhysicsData.m_fHeight = height;
-	}
-
-	void addIgnoredEntity(Entity* entity) {
-		m_PhysicsData.m_IgnoredEntities.push_back(entity);
-	}
-
-	bool shouldIgnoreEntityForPhysics(Entity* entity) const {
-		for (const auto& ignoredEntity : m_PhysicsData.m_IgnoredEntities) {
-			if (ignoredEntity == entity) {
-				return true;
-			}
-		}
-
-		if (entity -> GetPhysicsData().IsInAnyLayer(m_PhysicsData.getLayersToIgnore())) {
-			return true;
-		}
-		return false;
-	}
-
-	void SetVelocity(const sf::Vector2f& velocity) {
-		m_PhysicsData.m_vVelocity = velocity;
-	}
-
-	void SetTexture(const sf::Texture& texture) {
-		m_Sprite.setTexture(texture);
-	}
-
-	void SetScale(const sf::Vector2f& scale) {
-		m_Sprite.setScale(scale);
-	}
-
-	void SetOrigin(const sf::Vector2f& origin) {
-		m_Sprite.setOrigin(origin);
-	}
-
-	void SetPosition(const sf::Vector2f& position) {
-		m_Sprite.setPosition(position);
-	}
-
-	void SetColor(const sf::Color& color) {
-		m_Sprite.setColor(color);
-	}
-
-	void SetSprite(const sf::Sprite& sprite) {
-		m_Sprite = sprite;
-	}
-
-	const sf::Sprite& GetSprite() const {
-		return m_Sprite;
-	}
-
-	sf::Sprite& GetSpriteNonConst() {
-		return m_Sprite;
-	}
-
-	void move(const sf::Vector2f& offset) {
-		m_Sprite.move(offset);
-	}
-
-	void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
-		target.draw(m_Sprite, states);
-	}
-
-	sf::Vector2f GetPosition() const {
-		return m_Sprite.getPosition();
-	}
-
-	sf::Vector2i GetClosestGridCoordinates() const {
-		return sf::Vector2i(GetPosition().x / 160, GetPosition().y / 160);
-	}
-
-	PhysicsData::Type GetPhysicsShapeType() const {
-		return m_PhysicsData.m_eType;
-	}
-
-	const PhysicsData& GetPhysicsData() const {
-		return m_PhysicsData;
-	}
-	
-	PhysicsData& GetPhysicsDataNonConst() {
-		return m_PhysicsData;
-	}
-
-	void SetPathIndex(int index) {
-		m_iPathIndex = index;
-	}
-
-	int GetPathIndex() const {
-		return m_iPathIndex;
-	}
-
-	void OnCollision(Entity& pOtherEntity);
-
-	void SetHealth(int health) {
-		m_iHealth = health;
-	}
-
-	void DealDamage(int damage);
-
-	bool IsDeletionRequested() const {
-		return m_bDeletionRequested;
-	}
-
-	int getHealth() const {
-		return m_iHealth;
-	}
-
-	void RequestDeletion() {
-		m_bDeletionRequested = true;
-	}
-
-private:
-	sf::Sprite m_Sprite;
-	PhysicsData m_PhysicsData;
-	bool m_bDeletionRequested;
-
-	int m_iPathIndex;
-	int m_iHealth;
-public:
-	float m_fAxeTimer;
-	float m_fAttackTimer;
-};
-
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+using namespace std;
+#ifndef ENTITY_H	
+#define ENTITY_H
+
+class DamageEventBuffer;
+
+class Entity : public sf::Drawable
+{
+public:
+	struct PhysicsData {
+		enum Layer {
+			Enemy = 1, //0b0001
+			Tower = 2, //0b0010
+			Projectile = 4, // 0b0100
+			Wall = 8 // 0b1000
+		};
+		static constexpr int NumLayers = 4;
+
+		// Which layers each layer collides with, one row per layer bit. Enemies don't collide
+		// with each other here, UpdateCrowdSeparation keeps them apart.
+		static constexpr int LayerInteractions[NumLayers] = {
+			/* Enemy      */ Tower | Projectile | Wall,
+			/* Tower      */ Enemy,
+			/* Projectile */ Enemy,
+			/* Wall       */ Enemy
+		};
+
+		static constexpr bool IsLayerMatrixSymmetric() {
+			for (int i = 0; i < NumLayers; i++) {
+				for (int j = 0; j < NumLayers; j++) {
+					const bool bIToJ = (LayerInteractions[i] & (1 << j)) != 0;
+					const bool bJToI = (LayerInteractions[j] & (1 << i)) != 0;
+					if (bIToJ != bJToI) return false;
+				}
+			}
+			return true;
+		}
+
+		// Everything any of the given layers collides with
+		static constexpr int GetInteractingLayers(int layers) {
+			int iInteractions = 0;
+			for (int i = 0; i < NumLayers; i++) {
+				if (layers & (1 << i)) {
+					iInteractions |= LayerInteractions[i];
+				}
+			}
+			return iInteractions;
+		}
+		enum class Shape {
+			Circle,
+			Rectangle
+		};
+
+		enum class Type {
+			Static,
+			Dynamic,
+			Sensor // Moves like a dynamic body but only reports overlaps, nothing gets pushed apart
+		};
+		Shape m_eShape;
+		Type m_eType;
+
+		void setLayers(int layers) {
+			m_iMyLayer = layers;
+			UpdateInteractionMask();
+		}
+
+		// Lets one kind of body skip layers the matrix would otherwise collide it with
+		void setLayersToIgnore(int layers) {
+			m_iLayersToIgnore = layers;
+			UpdateInteractionMask();
+		}
+
+		int getLayersToIgnore() const {
+			return m_iLayersToIgnore;
+		}
+
+		bool IsInAnyLayer(int layer) const {
+			return (m_iMyLayer & layer) != 0;
+		}
+
+		bool CanInteractWith(const PhysicsData& other) const {
+			return (m_iInteractionMask & other.m_iMyLayer) != 0;
+		}
+
+		void UpdateInteractionMask() {
+			m_iInteractionMask = GetInteractingLayers(m_iMyLayer) & ~m_iLayersToIgnore;
+		}
+
+		int m_iMyLayer;
+		int m_iLayersToIgnore;
+		int m_iInteractionMask; // Layers we collide with, from the matrix minus the ignored ones
+
+		float m_fRadius; // For Circle shape
+		float m_fWidth; // For Rectangle shape
+		float m_fHeight; // For Rectangle shape
+	};
+
+	// Everything entities of one kind share, so each instance only carries its own state.
+	// Entities point at their prototype, it has to outlive them and must not move.
+	struct Prototype {
+		Prototype(PhysicsData::Type ePhysicsType);
+
+		void setCirclePhysics(float radius) {
+			m_PhysicsData.m_eShape = PhysicsData::Shape::Circle;
+			m_PhysicsData.m_fRadius = radius;
+		}
+
+		void setRectanglePhysics(float width, float height) {
+			m_PhysicsData.m_eShape = PhysicsData::Shape::Rectangle;
+			m_PhysicsData.m_fWidth = width;
+			m_PhysicsData.m_fHeight = height;
+		}
+
+		sf::Sprite m_Sprite; // Texture, texture rect, scale and origin. Position and rotation stay at zero.
+		PhysicsData m_PhysicsData;
+		int m_iHealth;
+	};
+	
+	Entity(const Prototype& rPrototype);
+	~Entity() {};
+
+	// Which enemy a tower throws at
+	enum class TargetingMode {
+		First, // Closest to its exit
+		Last,
+		Strongest,
+		Closest, // To the tower
+		NumModes
+	};
+
+	// Everything about an entity except its prototype, as plain data that can be copied bytewise
+	struct State {
+		sf::Vector2f vPosition;
+		float fRotation;
+		sf::Color color;
+		sf::Vector2f vVelocity;
+		sf::Vector2f vImpulse;
+		int iExitIndex;
+		int iHealth;
+		int iTimerDueTick;
+		float fSplashRadius;
+		int iTargetingMode;
+		int iSteeredCell;
+		sf::Vector2f vWaypoint;
+		bool bDeletionRequested;
+	};
+	State GetState() const;
+	void SetState(const State& rState);
+
+	void SetVelocity(const sf::Vector2f& velocity) {
+		m_vVelocity = velocity;
+	}
+
+	const sf::Vector2f& GetVelocity() const {
+		return m_vVelocity;
+	}
+
+	void AddImpulse(const sf::Vector2f& impulse) {
+		m_vImpulse += impulse;
+	}
+
+	void ClearImpulse() {
+		m_vImpulse = sf::Vector2f(0.0f, 0.0f);
+	}
+
+	const sf::Vector2f& GetImpulse() const {
+		return m_vImpulse;
+	}
+
+	void SetPosition(const sf::Vector2f& position) {
+		m_vPosition = position;
+	}
+
+	void SetColor(const sf::Color& color) {
+		m_Color = color;
+	}
+
+	const sf::Color& GetColor() const {
+		return m_Color;
+	}
+
+	void SetRotation(float fAngle) {
+		m_fRotation = fAngle;
+	}
+
+	void Rotate(float fAngle) {
+		m_fRotation = std::fmod(m_fRotation + fAngle, 360.0f);
+	}
+
+	float GetRotation() const {
+		return m_fRotation;
+	}
+
+	void move(const sf::Vector2f& offset) {
+		m_vPosition += offset;
+	}
+
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+	// Draws a prototype the way an entity with this transform and tint is drawn
+	static void DrawAppearance(sf::RenderTarget& target, sf::RenderStates states, const Prototype& rPrototype,
+		const sf::Vector2f& vPosition, float fRotation, const sf::Color& color);
+
+	sf::Vector2f GetPosition() const {
+		return m_vPosition;
+	}
+
+	sf::Vector2i GetClosestGridCoordinates() const {
+		return sf::Vector2i(GetPosition().x / 160, GetPosition().y / 160);
+	}
+
+	const Prototype& GetPrototype() const {
+		return *m_pPrototype;
+	}
+
+	PhysicsData::Type GetPhysicsShapeType() const {
+		return GetPhysicsData().m_eType;
+	}
+
+	const PhysicsData& GetPhysicsData() const {
+		return m_pPrototype -> m_PhysicsData;
+	}
+
+	// Which exit this enemy is walking to
+	void SetExitIndex(int index) {
+		m_iExitIndex = index;
+	}
+
+	int GetExitIndex() const {
+		return m_iExitIndex;
+	}
+
+	// Hits are only recorded here, Game applies them once the physics update is done
+	void OnCollision(Entity& pOtherEntity, DamageEventBuffer& rDamageEvents);
+
+	void SetHealth(int health) {
+		m_iHealth = health;
+	}
+
+	void DealDamage(int damage);
+
+	bool IsDeletionRequested() const {
+		return m_bDeletionRequested;
+	}
+
+	int getHealth() const {
+		return m_iHealth;
+	}
+
+	void RequestDeletion() {
+		m_bDeletionRequested = true;
+	}
+
+private:
+	const Prototype* m_pPrototype;
+
+	sf::Vector2f m_vPosition;
+	float m_fRotation;
+	sf::Color m_Color;
+
+	sf::Vector2f m_vVelocity;
+	sf::Vector2f m_vImpulse;
+
+	bool m_bDeletionRequested;
+
+	int m_iExitIndex;
+	int m_iHealth;
+public:
+	// Towers throw next and axes vanish on this tick of the game's timer wheels.
+	// The handle is only for the running game, snapshots reschedule from the due tick.
+	int m_iTimerDueTick;
+	int m_iTimerHandle;
+	TargetingMode m_eTargetingMode;
+	float m_fSplashRadius; // Towers pass it on to their axes, which hit everything this close to the impact
+	// Route cell an enemy last looked its waypoint up in, -1 before the first time or after the route changed.
+	// The waypoint is the same anywhere in that cell, so it is kept rather than looked up again.
+	int m_iSteeredCell;
+	sf::Vector2f m_vWaypoint;
+};
+
+static_assert(Entity::PhysicsData::IsLayerMatrixSymmetric(), "Layers must collide with each other both ways");
+
 #endif; 
\ No newline at end of file
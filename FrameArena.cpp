@@ -0,0 +1,75 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(std::size_t iCapacityBytes)
+	: m_pData(new char[iCapacityBytes])
+	, m_iCapacityBytes(iCapacityBytes)
+	, m_iOffset(0)
+	, m_iOverflowOffset(0)
+	, m_iOverflowBytesUsed(0)
+	, m_iPeakBytes(0)
+	, m_iOverflowCount(0)
+{
+	m_OverflowBlocks.reserve(16);
+}
+
+FrameArena::~FrameArena() {
+	for (const Block& rBlock : m_OverflowBlocks) {
+		delete[] rBlock.pData;
+	}
+	delete[] m_pData;
+}
+
+void* FrameArena::Allocate(std::size_t iBytes, std::size_t iAlignment) {
+	if (m_OverflowBlocks.empty()) {
+		const std::uintptr_t iAddress = reinterpret_cast<std::uintptr_t>(m_pData) + m_iOffset;
+		const std::size_t iPadding = (iAlignment - iAddress % iAlignment) % iAlignment;
+		if (m_iOffset + iPadding + iBytes <= m_iCapacityBytes) {
+			m_iOffset += iPadding + iBytes;
+			m_iPeakBytes = std::max(m_iPeakBytes, m_iOffset);
+			return m_pData + m_iOffset - iBytes;
+		}
+		m_iOverflowCount++;
+		AddOverflowBlock(iBytes + iAlignment);
+	}
+
+	Block* pBlock = &m_OverflowBlocks.back();
+	std::uintptr_t iAddress = reinterpret_cast<std::uintptr_t>(pBlock -> pData) + m_iOverflowOffset;
+	std::size_t iPadding = (iAlignment - iAddress % iAlignment) % iAlignment;
+	if (m_iOverflowOffset + iPadding + iBytes > pBlock -> iSize) {
+		AddOverflowBlock(iBytes + iAlignment);
+		pBlock = &m_OverflowBlocks.back();
+		iAddress = reinterpret_cast<std::uintptr_t>(pBlock -> pData);
+		iPadding = (iAlignment - iAddress % iAlignment) % iAlignment;
+	}
+	m_iOverflowOffset += iPadding + iBytes;
+	m_iOverflowBytesUsed += iPadding + iBytes;
+	m_iPeakBytes = std::max(m_iPeakBytes, m_iOffset + m_iOverflowBytesUsed);
+	return pBlock -> pData + m_iOverflowOffset - iBytes;
+}
+
+void FrameArena::AddOverflowBlock(std::size_t iMinBytes) {
+	Block block;
+	block.iSize = std::max(iMinBytes, m_iCapacityBytes);
+	block.pData = new char[block.iSize];
+	m_OverflowBlocks.push_back(block);
+	m_iOverflowOffset = 0;
+}
+
+void FrameArena::Reset() {
+	m_iOffset = 0;
+	if (m_OverflowBlocks.empty()) return;
+
+	// Grow into one block big enough for the worst tick so far, so the next one doesn't overflow
+	for (const Block& rBlock : m_OverflowBlocks) {
+		delete[] rBlock.pData;
+	}
+	m_OverflowBlocks.clear();
+	m_iOverflowOffset = 0;
+	m_iOverflowBytesUsed = 0;
+
+	delete[] m_pData;
+	m_iCapacityBytes = std::max(m_iCapacityBytes * 2, m_iPeakBytes);
+	m_pData = new char[m_iCapacityBytes];
+}
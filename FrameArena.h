@@ -0,0 +1,80 @@
+#ifndef FRAMEARENA
+#define FRAMEARENA
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+// Linear allocator for data that only lives for one tick. Allocating bumps a pointer and
+// freeing does nothing; everything is thrown away at once by Reset() at the start of the next tick.
+// If a tick needs more than the arena holds, extra blocks are taken from the heap and the
+// arena grows to fit on the next Reset(), so a steady game stops touching the heap.
+class FrameArena {
+public:
+	FrameArena(std::size_t iCapacityBytes);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(std::size_t iBytes, std::size_t iAlignment);
+	// Nothing allocated from the arena may be used after this
+	void Reset();
+
+	std::size_t GetCapacityBytes() const { return m_iCapacityBytes; }
+	std::size_t GetPeakBytes() const { return m_iPeakBytes; }
+	// Taken since the last Reset()
+	std::size_t GetBytesUsed() const { return m_iOffset + m_iOverflowBytesUsed; }
+	// Times a tick ran out of room and had to go to the heap
+	int GetOverflowCount() const { return m_iOverflowCount; }
+
+private:
+	struct Block {
+		char* pData;
+		std::size_t iSize;
+	};
+	void AddOverflowBlock(std::size_t iMinBytes);
+
+	char* m_pData;
+	std::size_t m_iCapacityBytes;
+	std::size_t m_iOffset;
+
+	// Blocks taken from the heap during the current tick, freed on Reset()
+	std::vector<Block> m_OverflowBlocks;
+	std::size_t m_iOverflowOffset;
+	std::size_t m_iOverflowBytesUsed;
+
+	std::size_t m_iPeakBytes;
+	int m_iOverflowCount;
+};
+
+// Lets STL containers take their storage from a FrameArena
+template <typename T>
+class FrameAllocator {
+public:
+	typedef T value_type;
+
+	FrameAllocator(FrameArena& rArena) : m_pArena(&rArena) {}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>& rOther) : m_pArena(rOther.GetArena()) {}
+
+	T* allocate(std::size_t iCount) {
+		return static_cast<T*>(m_pArena -> Allocate(iCount * sizeof(T), alignof(T)));
+	}
+	void deallocate(T*, std::size_t) {}
+
+	FrameArena* GetArena() const { return m_pArena; }
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>& rOther) const { return m_pArena == rOther.GetArena(); }
+	template <typename U>
+	bool operator!=(const FrameAllocator<U>& rOther) const { return m_pArena != rOther.GetArena(); }
+
+private:
+	FrameArena* m_pArena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif // !FRAMEARENA
@@ -0,0 +1,80 @@
+#include "FramePacer.h"
+#include <cmath>
+#include <algorithm>
+
+FramePacer::FramePacer(float fFramesPerSecond)
+	: m_iFrameMicros(0)
+	, m_iDeadline(0)
+	, m_iLastFrame(0)
+	, m_fNapMean(1000.0)
+	, m_fNapVariance(0.0)
+{
+	SetFrameRate(fFramesPerSecond);
+}
+
+void FramePacer::SetFrameRate(float fFramesPerSecond) {
+	m_iFrameMicros = fFramesPerSecond > 0.0f ? static_cast<sf::Int64>(1000000.0 / fFramesPerSecond) : 0;
+	m_iDeadline = Now();
+}
+
+void FramePacer::WaitForNextFrame() {
+	sf::Int64 iNow = Now();
+
+	if (m_iFrameMicros > 0) {
+		m_iDeadline += m_iFrameMicros;
+		// More than a frame behind, start again from now rather than rushing frames out to catch up
+		if (iNow > m_iDeadline + m_iFrameMicros) {
+			m_iDeadline = iNow;
+		}
+
+		// Naps can overshoot by a lot, only take one while the deadline is safely past the usual overshoot
+		while (m_iDeadline - iNow > m_fNapMean + std::sqrt(m_fNapVariance)) {
+			const sf::Int64 iNapStart = iNow;
+			sf::sleep(sf::milliseconds(1));
+			iNow = Now();
+
+			// Moving averages rather than all-time ones, so the estimate follows the machine
+			const double fNap = static_cast<double>(iNow - iNapStart);
+			const double fDelta = fNap - m_fNapMean;
+			m_fNapMean += fDelta * 0.05;
+			m_fNapVariance = (m_fNapVariance + fDelta * fDelta * 0.05) * 0.95;
+		}
+
+		while (iNow < m_iDeadline) {
+			iNow = Now();
+		}
+	}
+
+	if (m_iLastFrame > 0) {
+		const double fFrameSeconds = (iNow - m_iLastFrame) / 1000000.0;
+		m_Recent.Add(fFrameSeconds);
+		m_Overall.Add(fFrameSeconds);
+	}
+	m_iLastFrame = iNow;
+}
+
+bool FramePacer::TakeRecentStats(Stats& rStats) {
+	if (m_Recent.fSum < 1.0) return false;
+
+	rStats = m_Recent.GetStats();
+	m_Recent = Accumulator();
+	return true;
+}
+
+void FramePacer::Accumulator::Add(double fSeconds) {
+	iCount++;
+	fSum += fSeconds;
+	fSumOfSquares += fSeconds * fSeconds;
+	fWorst = std::max(fWorst, fSeconds);
+}
+
+FramePacer::Stats FramePacer::Accumulator::GetStats() const {
+	Stats stats;
+	if (iCount == 0) return stats;
+
+	stats.iFrames = iCount;
+	stats.fMeanSeconds = fSum / iCount;
+	stats.fJitterSeconds = std::sqrt(std::max(fSumOfSquares / iCount - stats.fMeanSeconds * stats.fMeanSeconds, 0.0));
+	stats.fWorstSeconds = fWorst;
+	return stats;
+}
@@ -0,0 +1,57 @@
+#ifndef FRAMEPACER
+#define FRAMEPACER
+
+#include <SFML/System.hpp>
+
+// Holds the render loop to a steady frame rate without burning a core. Each wait sleeps in short
+// naps while the next frame is further off than a nap tends to overshoot by, then spins the last
+// stretch. The overshoot estimate keeps adapting, since it drifts as the machine heats up.
+class FramePacer {
+public:
+	// How evenly frames came, over some stretch of them
+	struct Stats {
+		int iFrames = 0;
+		double fMeanSeconds = 0.0;
+		double fJitterSeconds = 0.0; // Standard deviation of the frame time
+		double fWorstSeconds = 0.0;
+	};
+
+	FramePacer(float fFramesPerSecond);
+
+	// 0 or less doesn't wait at all, frames only get measured
+	void SetFrameRate(float fFramesPerSecond);
+
+	// Blocks until the next frame is due
+	void WaitForNextFrame();
+
+	// Frames since the last call, about once a second. False until a second has gone by.
+	bool TakeRecentStats(Stats& rStats);
+	Stats GetOverallStats() const { return m_Overall.GetStats(); }
+
+private:
+	struct Accumulator {
+		int iCount = 0;
+		double fSum = 0.0;
+		double fSumOfSquares = 0.0;
+		double fWorst = 0.0;
+
+		void Add(double fSeconds);
+		Stats GetStats() const;
+	};
+
+	sf::Int64 Now() const { return m_Clock.getElapsedTime().asMicroseconds(); }
+
+	sf::Clock m_Clock;
+	sf::Int64 m_iFrameMicros;
+	sf::Int64 m_iDeadline;
+	sf::Int64 m_iLastFrame;
+
+	// Running estimate of how long a 1 ms nap really takes, in microseconds
+	double m_fNapMean;
+	double m_fNapVariance;
+
+	Accumulator m_Recent;
+	Accumulator m_Overall;
+};
+
+#endif // !FRAMEPACER
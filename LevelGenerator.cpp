@@ -0,0 +1,181 @@
+#include "LevelGenerator.h"
+#include <random>
+#include <algorithm>
+
+namespace {
+	const char* const StyleNames[] = { "lane", "serpentine", "maze", "open", "multilane" };
+
+	// Straight from the generator rather than through a distribution, whose output differs between
+	// standard libraries, so a seed gives the same level on every platform
+	int RandomBelow(std::mt19937& rRng, int iLimit) {
+		return static_cast<int>(rRng() % static_cast<unsigned int>(iLimit));
+	}
+
+	void SetCell(LevelGenerator::Level& rLevel, int x, int y, LevelGenerator::Cell eCell) {
+		rLevel.Cells[y * rLevel.iColumns + x] = eCell;
+	}
+}
+
+LevelGenerator::Level LevelGenerator::Generate(const Settings& rSettings) {
+	Level level;
+	// Anything smaller can't fit a route with bricks around it
+	level.iColumns = std::max(rSettings.iColumns, 3);
+	level.iRows = std::max(rSettings.iRows, 3);
+	level.Cells.assign(level.iColumns * level.iRows, Brick);
+
+	switch (rSettings.eStyle) {
+	case Serpentine:
+		MakeSerpentine(rSettings, level);
+		break;
+	case Maze:
+		MakeMaze(rSettings, level);
+		break;
+	case Open:
+		MakeOpen(rSettings, level);
+		break;
+	case MultiLane:
+		MakeMultiLane(rSettings, level);
+		break;
+	default:
+		MakeLane(level);
+		break;
+	}
+	return level;
+}
+
+const char* LevelGenerator::GetStyleName(Style eStyle) {
+	return eStyle >= 0 && eStyle < NumStyles ? StyleNames[eStyle] : "unknown";
+}
+
+bool LevelGenerator::FindStyle(const std::string& rName, Style& rStyle) {
+	for (int i = 0; i < NumStyles; i++) {
+		if (rName == StyleNames[i]) {
+			rStyle = static_cast<Style>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void LevelGenerator::MakeLane(Level& rLevel) {
+	const int y = rLevel.iRows / 2;
+	for (int x = 0; x < rLevel.iColumns; x++) {
+		SetCell(rLevel, x, y, x == 0 ? Spawn : x == rLevel.iColumns - 1 ? Exit : Path);
+	}
+}
+
+void LevelGenerator::MakeSerpentine(const Settings& rSettings, Level& rLevel) {
+	std::mt19937 rng(rSettings.uSeed);
+	const int iGap = 2 + RandomBelow(rng, 2); // Rows from one leg of the corridor to the next
+	bool bRightwards = RandomBelow(rng, 2) == 0;
+
+	const int iLeft = 1;
+	const int iRight = rLevel.iColumns - 2;
+	SetCell(rLevel, bRightwards ? 0 : rLevel.iColumns - 1, 1, Spawn);
+
+	int y = 1;
+	while (true) {
+		for (int x = iLeft; x <= iRight; x++) {
+			SetCell(rLevel, x, y, Path);
+		}
+
+		// Turn down at the far end, unless there isn't room for another leg
+		const int iTurnX = bRightwards ? iRight : iLeft;
+		if (y + iGap > rLevel.iRows - 2) {
+			SetCell(rLevel, bRightwards ? rLevel.iColumns - 1 : 0, y, Exit);
+			break;
+		}
+		for (int iStep = 1; iStep < iGap; iStep++) {
+			SetCell(rLevel, iTurnX, y + iStep, Path);
+		}
+		y += iGap;
+		bRightwards = !bRightwards;
+	}
+}
+
+void LevelGenerator::MakeMaze(const Settings& rSettings, Level& rLevel) {
+	std::mt19937 rng(rSettings.uSeed);
+
+	// Rooms sit on odd cells with a wall cell between neighbours, carved depth first so the
+	// maze branches everywhere and every room is reachable one way only
+	const int iRoomColumns = (rLevel.iColumns - 1) / 2;
+	const int iRoomRows = (rLevel.iRows - 1) / 2;
+	std::vector<std::uint8_t> Visited(iRoomColumns * iRoomRows, 0);
+	std::vector<int> Stack;
+
+	Visited[0] = 1;
+	SetCell(rLevel, 1, 1, Path);
+	Stack.push_back(0);
+	while (!Stack.empty()) {
+		const int iRoom = Stack.back();
+		const int iRoomX = iRoom % iRoomColumns;
+		const int iRoomY = iRoom / iRoomColumns;
+
+		int Unvisited[4];
+		int iUnvisitedCount = 0;
+		const int Offsets[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+		for (const int* pOffset : Offsets) {
+			const int iNextX = iRoomX + pOffset[0];
+			const int iNextY = iRoomY + pOffset[1];
+			if (iNextX < 0 || iNextY < 0 || iNextX >= iRoomColumns || iNextY >= iRoomRows) continue;
+			const int iNext = iNextY * iRoomColumns + iNextX;
+			if (!Visited[iNext]) Unvisited[iUnvisitedCount++] = iNext;
+		}
+
+		if (iUnvisitedCount == 0) {
+			Stack.pop_back();
+			continue;
+		}
+
+		const int iNext = Unvisited[RandomBelow(rng, iUnvisitedCount)];
+		const int iNextX = iNext % iRoomColumns;
+		const int iNextY = iNext / iRoomColumns;
+		Visited[iNext] = 1;
+		SetCell(rLevel, iRoomX + iNextX + 1, iRoomY + iNextY + 1, Path); // The wall between the two
+		SetCell(rLevel, iNextX * 2 + 1, iNextY * 2 + 1, Path);
+		Stack.push_back(iNext);
+	}
+
+	// In at the top left, out at the bottom right
+	SetCell(rLevel, 0, 1, Spawn);
+	const int iLastX = iRoomColumns * 2 - 1;
+	const int iLastY = iRoomRows * 2 - 1;
+	for (int x = iLastX + 1; x < rLevel.iColumns - 1; x++) {
+		SetCell(rLevel, x, iLastY, Path);
+	}
+	SetCell(rLevel, rLevel.iColumns - 1, iLastY, Exit);
+}
+
+void LevelGenerator::MakeOpen(const Settings& rSettings, Level& rLevel) {
+	std::mt19937 rng(rSettings.uSeed);
+
+	// Pillars only go on odd rows and columns, so the even rows and columns always join up
+	for (int y = 0; y < rLevel.iRows; y++) {
+		for (int x = 1; x < rLevel.iColumns - 1; x++) {
+			const bool bPillar = x % 2 == 1 && y % 2 == 1 && RandomBelow(rng, 2) == 0;
+			SetCell(rLevel, x, y, bPillar ? Brick : Path);
+		}
+	}
+
+	// Spawns and exits every few rows down the edges, always on an even row
+	for (int y = 2; y < rLevel.iRows; y += 4) {
+		SetCell(rLevel, 0, y, Spawn);
+		SetCell(rLevel, rLevel.iColumns - 1, y, Exit);
+	}
+}
+
+void LevelGenerator::MakeMultiLane(const Settings& rSettings, Level& rLevel) {
+	std::mt19937 rng(rSettings.uSeed);
+
+	// Lanes need a row of brick between them
+	const int iLanes = std::min(std::max(rSettings.iLanes, 1), (rLevel.iRows - 1) / 2);
+	for (int iLane = 0; iLane < iLanes; iLane++) {
+		const int y = (iLane + 1) * rLevel.iRows / (iLanes + 1);
+		const bool bRightwards = RandomBelow(rng, 2) == 0;
+		for (int x = 0; x < rLevel.iColumns; x++) {
+			SetCell(rLevel, x, y, Path);
+		}
+		SetCell(rLevel, 0, y, bRightwards ? Spawn : Exit);
+		SetCell(rLevel, rLevel.iColumns - 1, y, bRightwards ? Exit : Spawn);
+	}
+}
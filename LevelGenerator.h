@@ -0,0 +1,59 @@
+#ifndef LEVELGENERATOR
+#define LEVELGENERATOR
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Makes tile layouts of any size for benchmarking routing, physics and drawing, instead of
+// painting them by hand. The same settings and seed always give the same level.
+class LevelGenerator {
+public:
+	enum Style {
+		Lane, // One straight lane across the middle
+		Serpentine, // A single corridor folding back and forth across the whole map
+		Maze, // A branching maze with dead ends, one spawn and one exit
+		Open, // A wide field of path broken up by pillars, spawns down one side and exits down the other
+		MultiLane, // Separate straight lanes, each with its own spawn, running either way
+		NumStyles
+	};
+
+	// What goes in a cell, on top of the brick that fills the whole map
+	enum Cell : std::uint8_t {
+		Brick,
+		Spawn,
+		Exit,
+		Path
+	};
+
+	struct Settings {
+		Style eStyle = Lane;
+		int iColumns = 16;
+		int iRows = 10;
+		unsigned int uSeed = 1;
+		int iLanes = 3; // Only for MultiLane
+	};
+
+	struct Level {
+		int iColumns = 0;
+		int iRows = 0;
+		std::vector<Cell> Cells; // Row by row
+
+		Cell GetCell(int x, int y) const { return Cells[y * iColumns + x]; }
+	};
+
+	static Level Generate(const Settings& rSettings);
+
+	static const char* GetStyleName(Style eStyle);
+	// False for a name that isn't a style
+	static bool FindStyle(const std::string& rName, Style& rStyle);
+
+private:
+	static void MakeLane(Level& rLevel);
+	static void MakeSerpentine(const Settings& rSettings, Level& rLevel);
+	static void MakeMaze(const Settings& rSettings, Level& rLevel);
+	static void MakeOpen(const Settings& rSettings, Level& rLevel);
+	static void MakeMultiLane(const Settings& rSettings, Level& rLevel);
+};
+
+#endif // !LEVELGENERATOR
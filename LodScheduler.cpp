@@ -0,0 +1,31 @@
+#include "LodScheduler.h"
+
+LodScheduler::LodScheduler() {
+	// Enough that a normal match never has to wait, a stress run spreads its far crowd out
+	m_Budgets[Steering] = 256;
+	m_Budgets[AxeSpin] = 128;
+	ResetCursors();
+}
+
+void LodScheduler::SetBudget(Class eClass, int iUpdatesPerTick) {
+	m_Budgets[eClass] = iUpdatesPerTick;
+}
+
+int LodScheduler::Select(Class eClass, int iCandidates, int& rFirst) {
+	const int iBudget = m_Budgets[eClass];
+	if (iBudget <= 0 || iBudget >= iCandidates) {
+		rFirst = 0;
+		return iCandidates;
+	}
+
+	// The candidates change from tick to tick, so the cursor is only a rough place in the queue
+	rFirst = m_Cursors[eClass] % iCandidates;
+	m_Cursors[eClass] = (rFirst + iBudget) % iCandidates;
+	return iBudget;
+}
+
+void LodScheduler::ResetCursors() {
+	for (int i = 0; i < NumClasses; i++) {
+		m_Cursors[i] = 0;
+	}
+}
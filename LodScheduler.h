@@ -0,0 +1,35 @@
+#ifndef LODSCHEDULER
+#define LODSCHEDULER
+
+// Spreads low priority updates over several ticks. Whatever matters this tick the caller updates
+// as usual; the rest are candidates, and only a budgeted window of them, taken in turn, get their
+// update. Every candidate comes up again within candidates / budget ticks.
+class LodScheduler {
+public:
+	enum Class {
+		Steering, // Route lookups for enemies off screen and out of reach of every tower
+		AxeSpin, // Sprite rotation for axes off screen
+		NumClasses
+	};
+
+	LodScheduler();
+
+	// 0 or less updates every candidate every tick
+	void SetBudget(Class eClass, int iUpdatesPerTick);
+	int GetBudget(Class eClass) const { return m_Budgets[eClass]; }
+
+	// Candidates rFirst onwards get their update this tick, wrapping around past the last one.
+	// Returns how many that is.
+	int Select(Class eClass, int iCandidates, int& rFirst);
+
+	// Where each class picks up next tick, kept in snapshots so a restored match slices the same way
+	int GetCursor(Class eClass) const { return m_Cursors[eClass]; }
+	void SetCursor(Class eClass, int iCursor) { m_Cursors[eClass] = iCursor; }
+	void ResetCursors();
+
+private:
+	int m_Budgets[NumClasses];
+	int m_Cursors[NumClasses];
+};
+
+#endif // !LODSCHEDULER
@@ -0,0 +1,155 @@
+#include "MathBenchmark.h"
+#include "MathHelpers.h"
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+MathBenchmark::MathBenchmark(int iCount, unsigned int uSeed)
+	: m_X(iCount)
+	, m_Y(iCount)
+	, m_Positive(iCount)
+	, m_vPoint(640.0f, 360.0f)
+{
+	// Offsets the size of the play field, plus a few vectors on the axes and at zero
+	std::mt19937 rng(uSeed);
+	std::uniform_real_distribution<float> offset(-3000.0f, 3000.0f);
+	std::uniform_real_distribution<float> exponent(-20.0f, 20.0f);
+	for (int i = 0; i < iCount; i++) {
+		m_X[i] = offset(rng);
+		m_Y[i] = offset(rng);
+		m_Positive[i] = std::pow(2.0f, exponent(rng));
+	}
+	const sf::Vector2f specialCases[] = { { 0.0f, 0.0f }, { 0.0f, 5.0f }, { 0.0f, -5.0f }, { 5.0f, 0.0f }, { -5.0f, 0.0f }, { 3.0f, 3.0f }, { -3.0f, -3.0f } };
+	for (int i = 0; i < static_cast<int>(std::size(specialCases)) && i < iCount; i++) {
+		m_X[i] = specialCases[i].x;
+		m_Y[i] = specialCases[i].y;
+	}
+}
+
+bool MathBenchmark::CheckAccuracy(std::ostream& rStream) const {
+	const int iCount = static_cast<int>(m_X.size());
+	std::vector<float> out(iCount);
+	bool bPassed = true;
+
+	auto report = [&](const char* pName, double fWorst, double fBound) {
+		const bool bWithinBound = fWorst <= fBound;
+		rStream << "  " << pName << " worst error " << fWorst << " (bound " << fBound << ")" << (bWithinBound ? "" : "  FAILED") << "\n";
+		bPassed = bPassed && bWithinBound;
+	};
+
+	rStream << "Batch math accuracy over " << iCount << " vectors, " << MathHelpers::GetBatchBackendName() << "\n";
+
+	// Relative to the same sum in double precision
+	MathHelpers::DistanceSquaredBatch(m_X.data(), m_Y.data(), iCount, m_vPoint, out.data());
+	double fWorst = 0.0;
+	for (int i = 0; i < iCount; i++) {
+		const double dx = static_cast<double>(m_X[i]) - m_vPoint.x;
+		const double dy = static_cast<double>(m_Y[i]) - m_vPoint.y;
+		const double fExact = dx * dx + dy * dy;
+		if (fExact > 0.0) fWorst = std::max(fWorst, std::abs(out[i] - fExact) / fExact);
+	}
+	report("distance squared (relative)", fWorst, 1e-6);
+
+	MathHelpers::ReciprocalSqrtBatch(m_Positive.data(), iCount, out.data());
+	fWorst = 0.0;
+	for (int i = 0; i < iCount; i++) {
+		const double fExact = 1.0 / std::sqrt(static_cast<double>(m_Positive[i]));
+		fWorst = std::max(fWorst, std::abs(out[i] - fExact) / fExact);
+	}
+	report("reciprocal sqrt (relative)", fWorst, 1e-6);
+
+	// Unit length, and pointing the same way as normalize()
+	std::vector<float> x = m_X;
+	std::vector<float> y = m_Y;
+	MathHelpers::NormalizeBatch(x.data(), y.data(), iCount);
+	fWorst = 0.0;
+	for (int i = 0; i < iCount; i++) {
+		const sf::Vector2f vExpected = MathHelpers::normalize(sf::Vector2f(m_X[i], m_Y[i]));
+		fWorst = std::max(fWorst, static_cast<double>(std::abs(x[i] - vExpected.x)));
+		fWorst = std::max(fWorst, static_cast<double>(std::abs(y[i] - vExpected.y)));
+	}
+	report("normalize (per component)", fWorst, 1e-6);
+
+	MathHelpers::AngleBatch(m_X.data(), m_Y.data(), iCount, out.data());
+	fWorst = 0.0;
+	for (int i = 0; i < iCount; i++) {
+		// 359.9999 and 0 are the same direction
+		const double fDifference = std::abs(out[i] - MathHelpers::Angle(sf::Vector2f(m_X[i], m_Y[i])));
+		fWorst = std::max(fWorst, std::min(fDifference, 360.0 - fDifference));
+	}
+	report("angle (degrees)", fWorst, 1e-3);
+
+	return bPassed;
+}
+
+void MathBenchmark::Run(int iRepeats, std::ostream& rStream) const {
+	const int iCount = static_cast<int>(m_X.size());
+	std::vector<float> out(iCount);
+	std::vector<float> x(iCount);
+	std::vector<float> y(iCount);
+
+	// Summing the results keeps the compiler from throwing the work away
+	double fChecksum = 0.0;
+	auto time = [&](const char* pName, auto oneAtATime, auto batch) {
+		sf::Clock clock;
+		for (int iRepeat = 0; iRepeat < iRepeats; iRepeat++) {
+			oneAtATime();
+			fChecksum += out[iRepeat % iCount];
+		}
+		const float fOneAtATimeSeconds = clock.restart().asSeconds();
+		for (int iRepeat = 0; iRepeat < iRepeats; iRepeat++) {
+			batch();
+			fChecksum += out[iRepeat % iCount];
+		}
+		const float fBatchSeconds = clock.restart().asSeconds();
+
+		const double fScale = 1e9 / (static_cast<double>(iRepeats) * iCount);
+		rStream << "  " << pName << "  one at a time " << fOneAtATimeSeconds * fScale << " ns"
+			<< "  batch " << fBatchSeconds * fScale << " ns"
+			<< "  speedup " << fOneAtATimeSeconds / std::max(fBatchSeconds, 1e-9f) << "x\n";
+	};
+
+	rStream << "Batch math, ns per vector over " << iCount << " vectors, " << MathHelpers::GetBatchBackendName() << "\n";
+
+	time("distance squared",
+		[&]() {
+			for (int i = 0; i < iCount; i++) {
+				const float fDistance = MathHelpers::flength(sf::Vector2f(m_X[i], m_Y[i]) - m_vPoint);
+				out[i] = fDistance * fDistance;
+			}
+		},
+		[&]() { MathHelpers::DistanceSquaredBatch(m_X.data(), m_Y.data(), iCount, m_vPoint, out.data()); });
+
+	time("reciprocal sqrt ",
+		[&]() {
+			for (int i = 0; i < iCount; i++) {
+				out[i] = 1.0f / std::sqrt(m_Positive[i]);
+			}
+		},
+		[&]() { MathHelpers::ReciprocalSqrtBatch(m_Positive.data(), iCount, out.data()); });
+
+	time("normalize       ",
+		[&]() {
+			for (int i = 0; i < iCount; i++) {
+				const sf::Vector2f vNormalized = MathHelpers::normalize(sf::Vector2f(m_X[i], m_Y[i]));
+				x[i] = vNormalized.x;
+				out[i] = vNormalized.y;
+			}
+		},
+		[&]() {
+			std::copy(m_X.begin(), m_X.end(), x.begin());
+			std::copy(m_Y.begin(), m_Y.end(), out.begin());
+			MathHelpers::NormalizeBatch(x.data(), out.data(), iCount);
+		});
+
+	time("angle           ",
+		[&]() {
+			for (int i = 0; i < iCount; i++) {
+				out[i] = MathHelpers::Angle(sf::Vector2f(m_X[i], m_Y[i]));
+			}
+		},
+		[&]() { MathHelpers::AngleBatch(m_X.data(), m_Y.data(), iCount, out.data()); });
+
+	rStream << "  checksum " << fChecksum << "\n";
+}
@@ -0,0 +1,25 @@
+#ifndef MATHBENCHMARK
+#define MATHBENCHMARK
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <iostream>
+
+// Checks the batch math in MathHelpers against the one-vector functions and times both,
+// on the same random vectors so the numbers can be compared run to run
+class MathBenchmark {
+public:
+	MathBenchmark(int iCount, unsigned int uSeed);
+
+	// Prints the worst error of each batch function, false if any is out of its stated bound
+	bool CheckAccuracy(std::ostream& rStream) const;
+	void Run(int iRepeats, std::ostream& rStream) const;
+
+private:
+	std::vector<float> m_X;
+	std::vector<float> m_Y;
+	std::vector<float> m_Positive; // Inputs for the reciprocal square root
+	sf::Vector2f m_vPoint;
+};
+
+#endif // !MATHBENCHMARK
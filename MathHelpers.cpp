@@ -0,0 +1,177 @@
+﻿#include "MathHelpers.h"
+
+#ifdef MATHHELPERS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // atan on [0, 1] as an odd polynomial, good to about 1e-6 radians
+    constexpr float AtanCoefficients[6] = { 0.99997726f, -0.33262347f, 0.19354346f, -0.11643287f, 0.05265332f, -0.01172120f };
+
+    float AngleFromAtan(float x, float y) {
+        if (x == 0.0f && y == 0.0f) return 180.0f; // Same as Angle()
+
+        // Fold into the first octant, then unfold the result
+        const float ax = std::abs(x);
+        const float ay = std::abs(y);
+        const float a = std::min(ax, ay) / std::max(ax, ay);
+        const float s = a * a;
+        float r = ((((AtanCoefficients[5] * s + AtanCoefficients[4]) * s + AtanCoefficients[3]) * s
+            + AtanCoefficients[2]) * s + AtanCoefficients[1]) * s * a + AtanCoefficients[0] * a;
+        if (ay > ax) r = static_cast<float>(MathHelpers::HALF_PI) - r;
+        if (x < 0.0f) r = static_cast<float>(MathHelpers::PI) - r;
+        if (y < 0.0f) r = -r;
+
+        float fAngle = r - static_cast<float>(MathHelpers::HALF_PI);
+        if (fAngle < 0.0f) fAngle += static_cast<float>(MathHelpers::TWO_PI);
+        return fAngle * MathHelpers::RtoD;
+    }
+}
+
+namespace MathHelpers {
+#ifdef MATHHELPERS_SSE2
+    namespace {
+        // One Newton step on top of the hardware estimate takes it from 12 bits to nearly full precision
+        __m128 ReciprocalSqrt4(__m128 x) {
+            const __m128 y = _mm_rsqrt_ps(x);
+            const __m128 yyx = _mm_mul_ps(_mm_mul_ps(y, y), x);
+            return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), y), _mm_sub_ps(_mm_set1_ps(3.0f), yyx));
+        }
+
+        __m128 Select(__m128 mask, __m128 a, __m128 b) {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+    }
+
+    void DistanceSquaredBatch(const float* pX, const float* pY, int iCount, const sf::Vector2f& vPoint, float* pOut) {
+        const __m128 px = _mm_set1_ps(vPoint.x);
+        const __m128 py = _mm_set1_ps(vPoint.y);
+        int i = 0;
+        for (; i + 4 <= iCount; i += 4) {
+            const __m128 dx = _mm_sub_ps(_mm_loadu_ps(pX + i), px);
+            const __m128 dy = _mm_sub_ps(_mm_loadu_ps(pY + i), py);
+            _mm_storeu_ps(pOut + i, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        }
+        for (; i < iCount; i++) {
+            const float dx = pX[i] - vPoint.x;
+            const float dy = pY[i] - vPoint.y;
+            pOut[i] = dx * dx + dy * dy;
+        }
+    }
+
+    void ReciprocalSqrtBatch(const float* pIn, int iCount, float* pOut) {
+        int i = 0;
+        for (; i + 4 <= iCount; i += 4) {
+            _mm_storeu_ps(pOut + i, ReciprocalSqrt4(_mm_loadu_ps(pIn + i)));
+        }
+        // The tail goes through the same path so every element gets the same rounding
+        if (i < iCount) {
+            float in[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            float out[4];
+            std::copy(pIn + i, pIn + iCount, in);
+            _mm_storeu_ps(out, ReciprocalSqrt4(_mm_loadu_ps(in)));
+            std::copy(out, out + (iCount - i), pOut + i);
+        }
+    }
+
+    void NormalizeBatch(float* pX, float* pY, int iCount) {
+        const __m128 zero = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 4 <= iCount; i += 4) {
+            const __m128 x = _mm_loadu_ps(pX + i);
+            const __m128 y = _mm_loadu_ps(pY + i);
+            const __m128 lengthSquared = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+            // Zero vectors would come out as NaN, keep them as they were
+            const __m128 isZero = _mm_cmpeq_ps(lengthSquared, zero);
+            const __m128 scale = ReciprocalSqrt4(lengthSquared);
+            _mm_storeu_ps(pX + i, Select(isZero, x, _mm_mul_ps(x, scale)));
+            _mm_storeu_ps(pY + i, Select(isZero, y, _mm_mul_ps(y, scale)));
+        }
+        if (i < iCount) {
+            float x[4] = {};
+            float y[4] = {};
+            std::copy(pX + i, pX + iCount, x);
+            std::copy(pY + i, pY + iCount, y);
+            NormalizeBatch(x, y, 4);
+            std::copy(x, x + (iCount - i), pX + i);
+            std::copy(y, y + (iCount - i), pY + i);
+        }
+    }
+
+    void AngleBatch(const float* pX, const float* pY, int iCount, float* pOut) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 halfPi = _mm_set1_ps(static_cast<float>(HALF_PI));
+        const __m128 pi = _mm_set1_ps(static_cast<float>(PI));
+        const __m128 twoPi = _mm_set1_ps(static_cast<float>(TWO_PI));
+        int i = 0;
+        for (; i + 4 <= iCount; i += 4) {
+            const __m128 x = _mm_loadu_ps(pX + i);
+            const __m128 y = _mm_loadu_ps(pY + i);
+            const __m128 ax = _mm_andnot_ps(signMask, x);
+            const __m128 ay = _mm_andnot_ps(signMask, y);
+            const __m128 largest = _mm_max_ps(ax, ay);
+            const __m128 isZero = _mm_cmpeq_ps(largest, zero);
+
+            // Dividing by one instead of zero keeps the lanes for zero vectors finite
+            const __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), Select(isZero, _mm_set1_ps(1.0f), largest));
+            const __m128 s = _mm_mul_ps(a, a);
+            __m128 r = _mm_set1_ps(AtanCoefficients[5]);
+            for (int c = 4; c >= 1; c--) {
+                r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(AtanCoefficients[c]));
+            }
+            r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(r, s), a), _mm_mul_ps(_mm_set1_ps(AtanCoefficients[0]), a));
+
+            r = Select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(halfPi, r), r);
+            r = Select(_mm_cmplt_ps(x, zero), _mm_sub_ps(pi, r), r);
+            r = Select(_mm_cmplt_ps(y, zero), _mm_sub_ps(zero, r), r);
+
+            __m128 angle = _mm_sub_ps(r, halfPi);
+            angle = _mm_add_ps(angle, _mm_and_ps(_mm_cmplt_ps(angle, zero), twoPi));
+            angle = _mm_mul_ps(angle, _mm_set1_ps(RtoD));
+            _mm_storeu_ps(pOut + i, Select(isZero, _mm_set1_ps(180.0f), angle));
+        }
+        for (; i < iCount; i++) {
+            pOut[i] = AngleFromAtan(pX[i], pY[i]);
+        }
+    }
+
+    const char* GetBatchBackendName() {
+        return "SSE2";
+    }
+#else
+    void DistanceSquaredBatch(const float* pX, const float* pY, int iCount, const sf::Vector2f& vPoint, float* pOut) {
+        for (int i = 0; i < iCount; i++) {
+            const float dx = pX[i] - vPoint.x;
+            const float dy = pY[i] - vPoint.y;
+            pOut[i] = dx * dx + dy * dy;
+        }
+    }
+
+    void ReciprocalSqrtBatch(const float* pIn, int iCount, float* pOut) {
+        for (int i = 0; i < iCount; i++) {
+            pOut[i] = 1.0f / std::sqrt(pIn[i]);
+        }
+    }
+
+    void NormalizeBatch(float* pX, float* pY, int iCount) {
+        for (int i = 0; i < iCount; i++) {
+            const float fLengthSquared = pX[i] * pX[i] + pY[i] * pY[i];
+            if (fLengthSquared == 0.0f) continue;
+            const float fScale = 1.0f / std::sqrt(fLengthSquared);
+            pX[i] *= fScale;
+            pY[i] *= fScale;
+        }
+    }
+
+    void AngleBatch(const float* pX, const float* pY, int iCount, float* pOut) {
+        for (int i = 0; i < iCount; i++) {
+            pOut[i] = AngleFromAtan(pX[i], pY[i]);
+        }
+    }
+
+    const char* GetBatchBackendName() {
+        return "scalar";
+    }
+#endif
+}
@@ -1,44 +1,82 @@
-﻿#pragma once
-#include <SFML/Graphics.hpp>
-#include <cmath>
-
-namespace MathHelpers {
-    constexpr float DtoR = 0.0174533f;
-    constexpr float RtoD = 57.2958f;
-    constexpr float SQRT2 = 1.41421356237f;
-    constexpr double PI = 3.14159265358979323846;
-    constexpr double HALF_PI = PI / 2.0;
-    constexpr double QUARTER_PI = PI / 4.0;
-    constexpr double EIGHTH_PI = PI / 8.0;
-    constexpr double TWO_PI = 2.0 * PI;
-
-    static float flength(const sf::Vector2f& rVector) {
-        float flength = sqrt(rVector.x * rVector.x + rVector.y * rVector.y);
-        return flength;
-    }
-
-    static sf::Vector2f normalize(const sf::Vector2f& rVector) {
-        if (rVector.x == 0 && rVector.y == 0) {
-            return rVector; // Avoid division by zero
-		}
-
-        float length = flength(rVector);
-        sf::Vector2f vNormalizeVector(rVector.x / length, rVector.y / length);
-        return vNormalizeVector;
-    }
-
-    static constexpr float Angle(const sf::Vector2f& a) {
-        if (a.x == 0) {
-            if (a.y > 0) {
-                return 0.0f;
-            }
-            return 180.0;
-        }
-        float angle = atan2f(a.y, a.x) - HALF_PI;
-
-        if (angle < 0.0f) {
-            angle += TWO_PI;
-        }
-        return angle * RtoD;
-    }
+﻿#pragma once
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <algorithm>
+
+// Batch functions below use SSE2 where the compiler targets it, and plain loops everywhere else.
+// Define MATHHELPERS_NO_SIMD to force the plain loops.
+#if !defined(MATHHELPERS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATHHELPERS_SSE2
+#endif
+
+namespace MathHelpers {
+    constexpr float DtoR = 0.0174533f;
+    constexpr float RtoD = 57.2958f;
+    constexpr float SQRT2 = 1.41421356237f;
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double HALF_PI = PI / 2.0;
+    constexpr double QUARTER_PI = PI / 4.0;
+    constexpr double EIGHTH_PI = PI / 8.0;
+    constexpr double TWO_PI = 2.0 * PI;
+
+    static float flength(const sf::Vector2f& rVector) {
+        float flength = sqrt(rVector.x * rVector.x + rVector.y * rVector.y);
+        return flength;
+    }
+
+    static sf::Vector2f normalize(const sf::Vector2f& rVector) {
+        if (rVector.x == 0 && rVector.y == 0) {
+            return rVector; // Avoid division by zero
+		}
+
+        float length = flength(rVector);
+        sf::Vector2f vNormalizeVector(rVector.x / length, rVector.y / length);
+        return vNormalizeVector;
+    }
+
+    static sf::Vector2f ClosestPointOnSegment(const sf::Vector2f& rStart, const sf::Vector2f& rEnd, const sf::Vector2f& rPoint) {
+        const sf::Vector2f vSegment = rEnd - rStart;
+        const float fSegmentLengthSquared = vSegment.x * vSegment.x + vSegment.y * vSegment.y;
+        if (fSegmentLengthSquared == 0.0f) {
+            return rStart; // Degenerate segment, the start is the only point
+        }
+
+        const sf::Vector2f vStartToPoint = rPoint - rStart;
+        float t = (vStartToPoint.x * vSegment.x + vStartToPoint.y * vSegment.y) / fSegmentLengthSquared;
+        t = std::clamp(t, 0.0f, 1.0f);
+        return rStart + vSegment * t;
+    }
+
+    static constexpr float Angle(const sf::Vector2f& a) {
+        if (a.x == 0) {
+            if (a.y > 0) {
+                return 0.0f;
+            }
+            return 180.0;
+        }
+        float angle = atan2f(a.y, a.x) - HALF_PI;
+
+        if (angle < 0.0f) {
+            angle += TWO_PI;
+        }
+        return angle * RtoD;
+    }
+
+    // Batch versions over packed arrays, one x and one y array per set of vectors.
+    // Arrays don't need any particular alignment and may be any length.
+
+    // pOut[i] = squared distance from (pX[i], pY[i]) to vPoint, for comparing without a sqrt
+    void DistanceSquaredBatch(const float* pX, const float* pY, int iCount, const sf::Vector2f& vPoint, float* pOut);
+
+    // pOut[i] = 1 / sqrt(pIn[i]) for positive inputs, within 1e-6 relative error
+    void ReciprocalSqrtBatch(const float* pIn, int iCount, float* pOut);
+
+    // Scales every vector to unit length in place, zero vectors are left alone like normalize()
+    void NormalizeBatch(float* pX, float* pY, int iCount);
+
+    // pOut[i] = Angle() of each vector in degrees, within 0.001 degrees of it
+    void AngleBatch(const float* pX, const float* pY, int iCount, float* pOut);
+
+    // "SSE2" or "scalar", for benchmark output
+    const char* GetBatchBackendName();
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "MetricsRegistry.h"
+#include <algorithm>
+
+MetricsRegistry::Histogram::Histogram(const std::vector<double>& rUpperBounds)
+	: m_UpperBounds(rUpperBounds)
+	, m_BucketCounts(rUpperBounds.size() + 1)
+	, m_iCount(0)
+	, m_iSumMicros(0)
+{
+	std::sort(m_UpperBounds.begin(), m_UpperBounds.end());
+	for (std::atomic<std::uint64_t>& rBucketCount : m_BucketCounts) {
+		rBucketCount.store(0, std::memory_order_relaxed);
+	}
+}
+
+void MetricsRegistry::Histogram::Observe(double fValue) {
+	const int iBucket = static_cast<int>(std::lower_bound(m_UpperBounds.begin(), m_UpperBounds.end(), fValue) - m_UpperBounds.begin());
+	m_BucketCounts[iBucket].fetch_add(1, std::memory_order_relaxed);
+	m_iCount.fetch_add(1, std::memory_order_relaxed);
+	m_iSumMicros.fetch_add(static_cast<std::uint64_t>(std::max(fValue, 0.0) * 1000000.0), std::memory_order_relaxed);
+}
+
+MetricsRegistry::Counter& MetricsRegistry::AddCounter(const std::string& rName, const std::string& rHelp) {
+	m_Entries.push_back({ rName, rHelp, CounterKind, static_cast<int>(m_Counters.size()) });
+	return m_Counters.emplace_back();
+}
+
+MetricsRegistry::Gauge& MetricsRegistry::AddGauge(const std::string& rName, const std::string& rHelp) {
+	m_Entries.push_back({ rName, rHelp, GaugeKind, static_cast<int>(m_Gauges.size()) });
+	return m_Gauges.emplace_back();
+}
+
+MetricsRegistry::Histogram& MetricsRegistry::AddHistogram(const std::string& rName, const std::string& rHelp, const std::vector<double>& rUpperBounds) {
+	m_Entries.push_back({ rName, rHelp, HistogramKind, static_cast<int>(m_Histograms.size()) });
+	return m_Histograms.emplace_back(rUpperBounds);
+}
+
+void MetricsRegistry::WriteText(std::ostream& rStream) const {
+	for (const Entry& rEntry : m_Entries) {
+		rStream << "# HELP " << rEntry.name << " " << rEntry.help << "\n";
+
+		switch (rEntry.eKind) {
+		case CounterKind:
+			rStream << "# TYPE " << rEntry.name << " counter\n";
+			rStream << rEntry.name << " " << m_Counters[rEntry.iIndex].Get() << "\n";
+			break;
+		case GaugeKind:
+			rStream << "# TYPE " << rEntry.name << " gauge\n";
+			rStream << rEntry.name << " " << m_Gauges[rEntry.iIndex].Get() << "\n";
+			break;
+		case HistogramKind: {
+			const Histogram& rHistogram = m_Histograms[rEntry.iIndex];
+			rStream << "# TYPE " << rEntry.name << " histogram\n";
+
+			// Buckets are cumulative in the scrape format
+			std::uint64_t iCumulative = 0;
+			const std::vector<double>& rUpperBounds = rHistogram.GetUpperBounds();
+			for (int i = 0; i < static_cast<int>(rUpperBounds.size()); i++) {
+				iCumulative += rHistogram.GetBucketCount(i);
+				rStream << rEntry.name << "_bucket{le=\"" << rUpperBounds[i] << "\"} " << iCumulative << "\n";
+			}
+			iCumulative += rHistogram.GetBucketCount(static_cast<int>(rUpperBounds.size()));
+			rStream << rEntry.name << "_bucket{le=\"+Inf\"} " << iCumulative << "\n";
+			rStream << rEntry.name << "_sum " << rHistogram.GetSum() << "\n";
+			rStream << rEntry.name << "_count " << rHistogram.GetCount() << "\n";
+			break;
+		}
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef METRICSREGISTRY
+#define METRICSREGISTRY
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <string>
+#include <iostream>
+
+// Named counters, gauges and histograms that the simulation updates and another thread reads.
+// Metrics are registered up front; after that every update is a relaxed atomic, so the
+// simulation never waits on whoever is reading them.
+class MetricsRegistry {
+public:
+	// Only ever goes up
+	class Counter {
+	public:
+		Counter() : m_iValue(0) {}
+		void Add(std::uint64_t iAmount) { m_iValue.fetch_add(iAmount, std::memory_order_relaxed); }
+		std::uint64_t Get() const { return m_iValue.load(std::memory_order_relaxed); }
+	private:
+		std::atomic<std::uint64_t> m_iValue;
+	};
+
+	// The latest value of something
+	class Gauge {
+	public:
+		Gauge() : m_fValue(0.0) {}
+		void Set(double fValue) { m_fValue.store(fValue, std::memory_order_relaxed); }
+		double Get() const { return m_fValue.load(std::memory_order_relaxed); }
+	private:
+		std::atomic<double> m_fValue;
+	};
+
+	// Counts observations into fixed buckets, each bucket holding everything up to its bound
+	class Histogram {
+	public:
+		Histogram(const std::vector<double>& rUpperBounds);
+		void Observe(double fValue);
+
+		const std::vector<double>& GetUpperBounds() const { return m_UpperBounds; }
+		std::uint64_t GetBucketCount(int iBucket) const { return m_BucketCounts[iBucket].load(std::memory_order_relaxed); }
+		std::uint64_t GetCount() const { return m_iCount.load(std::memory_order_relaxed); }
+		double GetSum() const { return m_iSumMicros.load(std::memory_order_relaxed) / 1000000.0; }
+	private:
+		std::vector<double> m_UpperBounds;
+		std::deque<std::atomic<std::uint64_t>> m_BucketCounts; // One past the bounds for +Inf
+		std::atomic<std::uint64_t> m_iCount;
+		std::atomic<std::uint64_t> m_iSumMicros; // Kept in millionths so it can be added atomically
+	};
+
+	// Returned references stay valid for the life of the registry
+	Counter& AddCounter(const std::string& rName, const std::string& rHelp);
+	Gauge& AddGauge(const std::string& rName, const std::string& rHelp);
+	Histogram& AddHistogram(const std::string& rName, const std::string& rHelp, const std::vector<double>& rUpperBounds);
+
+	// Plain-text scrape format, one "name value" line per series
+	void WriteText(std::ostream& rStream) const;
+
+private:
+	enum Kind {
+		CounterKind,
+		GaugeKind,
+		HistogramKind
+	};
+
+	struct Entry {
+		std::string name;
+		std::string help;
+		Kind eKind;
+		int iIndex;
+	};
+
+	std::vector<Entry> m_Entries;
+	std::deque<Counter> m_Counters;
+	std::deque<Gauge> m_Gauges;
+	std::deque<Histogram> m_Histograms;
+};
+
+#endif // !METRICSREGISTRY
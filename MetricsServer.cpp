@@ -0,0 +1,71 @@
+#include "MetricsServer.h"
+#include <sstream>
+
+MetricsServer::MetricsServer(const MetricsRegistry& rRegistry)
+	: m_rRegistry(rRegistry)
+	, m_bRunning(false)
+{}
+
+MetricsServer::~MetricsServer() {
+	Stop();
+}
+
+bool MetricsServer::Start(unsigned short iPort) {
+	if (m_bRunning) return true;
+
+	// Loopback only, the numbers are for dashboards on this machine
+	if (m_Listener.listen(iPort, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+		return false;
+	}
+	m_bRunning = true;
+	m_Thread = std::thread(&MetricsServer::Serve, this);
+	return true;
+}
+
+void MetricsServer::Stop() {
+	if (!m_bRunning) return;
+	m_bRunning = false;
+	m_Thread.join();
+	m_Listener.close();
+}
+
+void MetricsServer::Serve() {
+	// Wake up regularly so Stop() doesn't wait on a client that never comes
+	sf::SocketSelector selector;
+	selector.add(m_Listener);
+
+	while (m_bRunning) {
+		if (!selector.wait(sf::milliseconds(200))) continue;
+
+		sf::TcpSocket client;
+		if (m_Listener.accept(client) == sf::Socket::Done) {
+			Respond(client);
+			client.disconnect();
+		}
+	}
+}
+
+void MetricsServer::Respond(sf::TcpSocket& rClient) {
+	// A client that connects and never sends would hold up the only thread, and Stop() with it
+	sf::SocketSelector selector;
+	selector.add(rClient);
+	if (!selector.wait(sf::milliseconds(200))) return;
+
+	// The request itself doesn't matter, read what has arrived and answer
+	char buffer[1024];
+	std::size_t iReceived = 0;
+	rClient.receive(buffer, sizeof(buffer), iReceived);
+
+	std::ostringstream body;
+	m_rRegistry.WriteText(body);
+	const std::string bodyText = body.str();
+
+	std::ostringstream response;
+	response << "HTTP/1.0 200 OK\r\n"
+		<< "Content-Type: text/plain; version=0.0.4\r\n"
+		<< "Content-Length: " << bodyText.size() << "\r\n"
+		<< "Connection: close\r\n\r\n"
+		<< bodyText;
+	const std::string responseText = response.str();
+	rClient.send(responseText.data(), responseText.size());
+}
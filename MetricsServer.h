@@ -0,0 +1,30 @@
+#ifndef METRICSSERVER
+#define METRICSSERVER
+
+#include <SFML/Network.hpp>
+#include <thread>
+#include <atomic>
+#include "MetricsRegistry.h"
+
+// Serves a registry over HTTP on the loopback address from a background thread.
+// Any request gets the whole registry back in the plain-text scrape format.
+class MetricsServer {
+public:
+	MetricsServer(const MetricsRegistry& rRegistry);
+	~MetricsServer();
+
+	// False if the port couldn't be opened
+	bool Start(unsigned short iPort);
+	void Stop();
+
+private:
+	void Serve();
+	void Respond(sf::TcpSocket& rClient);
+
+	const MetricsRegistry& m_rRegistry;
+	sf::TcpListener m_Listener;
+	std::thread m_Thread;
+	std::atomic<bool> m_bRunning;
+};
+
+#endif // !METRICSSERVER
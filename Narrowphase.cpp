@@ -0,0 +1,78 @@
+#include "Narrowphase.h"
+#include "MathHelpers.h"
+#include <algorithm>
+
+namespace Narrowphase {
+	static Contact NoContact() {
+		Contact contact;
+		contact.bColliding = false;
+		contact.vNormal = sf::Vector2f(0.0f, 0.0f);
+		contact.fDepth = 0.0f;
+		return contact;
+	}
+
+	Contact CircleCircle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2) {
+		const sf::Vector2f vEntity1ToEntity2 = vPosition2 - vPosition1;
+		const float fDistanceBeeenEntities = MathHelpers::flength(vEntity1ToEntity2);
+		const float fSumOfRadii = rShape1.m_fRadius + rShape2.m_fRadius;
+
+		if (fDistanceBeeenEntities >= fSumOfRadii) {
+			return NoContact();
+		}
+
+		Contact contact;
+		contact.bColliding = true;
+		contact.vNormal = MathHelpers::normalize(vEntity1ToEntity2);
+		contact.fDepth = fSumOfRadii - fDistanceBeeenEntities;
+		return contact;
+	}
+
+	Contact CircleRectangle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2) {
+		float fClosestX = std::clamp(vPosition1.x, vPosition2.x - rShape2.m_fWidth / 2, vPosition2.x + rShape2.m_fWidth / 2);
+		float fClosestY = std::clamp(vPosition1.y, vPosition2.y - rShape2.m_fHeight / 2, vPosition2.y + rShape2.m_fHeight / 2);
+
+		sf::Vector2f vClosestPoint(fClosestX, fClosestY);
+		sf::Vector2f vCircleToClosestPoint = vClosestPoint - vPosition1;
+		float fDistanceToClosestPoint = MathHelpers::flength(vCircleToClosestPoint);
+
+		if (fDistanceToClosestPoint >= rShape1.m_fRadius) {
+			return NoContact();
+		}
+
+		Contact contact;
+		contact.bColliding = true;
+		contact.vNormal = MathHelpers::normalize(vCircleToClosestPoint);
+		contact.fDepth = rShape1.m_fRadius - fDistanceToClosestPoint;
+		return contact;
+	}
+
+	Contact RectangleCircle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2) {
+		// Same test with the bodies swapped, then flip the normal back to point from 1 to 2
+		Contact contact = CircleRectangle(vPosition2, rShape2, vPosition1, rShape1);
+		contact.vNormal = -contact.vNormal;
+		return contact;
+	}
+
+	Contact RectangleRectangle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2) {
+		float fDistanceX = std::abs(vPosition1.x - vPosition2.x);
+		float fDistanceY = std::abs(vPosition1.y - vPosition2.y);
+
+		float fOverlapX = (rShape1.m_fWidth + rShape2.m_fWidth) / 2 - fDistanceX;
+		float fOverlapY = (rShape1.m_fHeight + rShape2.m_fHeight) / 2 - fDistanceY;
+		if (fOverlapX <= 0 || fOverlapY <= 0) {
+			return NoContact();
+		}
+
+		// Push out along whichever axis overlaps least
+		Contact contact;
+		contact.bColliding = true;
+		if (fOverlapX < fOverlapY) {
+			contact.vNormal = sf::Vector2f(vPosition1.x < vPosition2.x ? 1.0f : -1.0f, 0.0f);
+			contact.fDepth = fOverlapX;
+		} else {
+			contact.vNormal = sf::Vector2f(0.0f, vPosition1.y < vPosition2.y ? 1.0f : -1.0f);
+			contact.fDepth = fOverlapY;
+		}
+		return contact;
+	}
+}
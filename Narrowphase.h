@@ -0,0 +1,39 @@
+#ifndef NARROWPHASE
+#define NARROWPHASE
+
+#include <SFML/Graphics.hpp>
+#include "Entity.h"
+
+// Exact shape-vs-shape tests, shared by collision detection and collision resolution
+namespace Narrowphase {
+	struct Contact {
+		bool bColliding;
+		sf::Vector2f vNormal; // Points from the first body towards the second
+		float fDepth; // How far the bodies overlap along the normal
+	};
+
+	typedef Contact (*ContactFunction)(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1,
+		const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2);
+
+	Contact CircleCircle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2);
+	Contact CircleRectangle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2);
+	Contact RectangleCircle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2);
+	Contact RectangleRectangle(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1, const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2);
+
+	// Indexed by [shape of the first body][shape of the second body]
+	constexpr ContactFunction ContactTable[2][2] = {
+		{ CircleCircle, CircleRectangle },
+		{ RectangleCircle, RectangleRectangle }
+	};
+
+	inline Contact FindContact(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1,
+		const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2) {
+		return ContactTable[static_cast<int>(rShape1.m_eShape)][static_cast<int>(rShape2.m_eShape)](vPosition1, rShape1, vPosition2, rShape2);
+	}
+
+	inline Contact FindContact(const Entity& entity1, const Entity& entity2) {
+		return FindContact(entity1.GetPosition(), entity1.GetPhysicsData(), entity2.GetPosition(), entity2.GetPhysicsData());
+	}
+}
+
+#endif // !NARROWPHASE
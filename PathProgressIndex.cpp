@@ -0,0 +1,59 @@
+#include "PathProgressIndex.h"
+
+void PathProgressIndex::Clear() {
+	m_Order.clear();
+	m_iTrackedCount = 0;
+	m_iStrongest = -1;
+}
+
+void PathProgressIndex::Update(const std::vector<Entity>& rEnemies, const RouteMap& rRouteMap) {
+	const int iEnemyCount = static_cast<int>(rEnemies.size());
+	if (iEnemyCount < m_iTrackedCount) {
+		Clear(); // The list was replaced, the old order means nothing now
+	}
+	for (int i = m_iTrackedCount; i < iEnemyCount; i++) {
+		m_Order.push_back({ i, 0.0f });
+	}
+	m_iTrackedCount = iEnemyCount;
+
+	for (Entry& rEntry : m_Order) {
+		const Entity& rEnemy = rEnemies[rEntry.iEnemy];
+		rEntry.fRemainingDistance = rRouteMap.GetRemainingDistance(rEnemy.GetExitIndex(), rEnemy.GetPosition());
+	}
+
+	// Insertion sort, linear when only a few neighbours swapped places since last tick.
+	// New enemies start at the back, which is about where a fresh spawn belongs.
+	for (int i = 1; i < static_cast<int>(m_Order.size()); i++) {
+		const Entry entry = m_Order[i];
+		int j = i;
+		while (j > 0 && m_Order[j - 1].fRemainingDistance > entry.fRemainingDistance) {
+			m_Order[j] = m_Order[j - 1];
+			j--;
+		}
+		m_Order[j] = entry;
+	}
+
+	m_iStrongest = -1;
+	int iMostHealth = 0;
+	for (const Entry& rEntry : m_Order) {
+		const int iHealth = rEnemies[rEntry.iEnemy].getHealth();
+		if (m_iStrongest < 0 || iHealth > iMostHealth) {
+			m_iStrongest = rEntry.iEnemy;
+			iMostHealth = iHealth;
+		}
+	}
+}
+
+void PathProgressIndex::Remap(const int* pNewIndices) {
+	int iKept = 0;
+	for (const Entry& rEntry : m_Order) {
+		const int iNewIndex = pNewIndices[rEntry.iEnemy];
+		if (iNewIndex < 0) continue;
+		m_Order[iKept] = { iNewIndex, rEntry.fRemainingDistance };
+		iKept++;
+	}
+	m_Order.resize(iKept);
+	// Compaction keeps the order, so enemies spawned since the last update still come after these
+	m_iTrackedCount = iKept;
+	m_iStrongest = -1; // Until the next update
+}
@@ -0,0 +1,38 @@
+#ifndef PATHPROGRESSINDEX
+#define PATHPROGRESSINDEX
+
+#include <vector>
+#include "Entity.h"
+#include "RouteMap.h"
+
+// Keeps the enemies ordered by how far they still have to walk, for towers picking a target.
+// Enemies only move a little each tick, so the order from the last tick is nearly right and
+// fixing it up is close to one pass. The front and back, and the strongest, are then constant time.
+class PathProgressIndex {
+public:
+	void Clear();
+
+	// Re-measures every enemy and restores the order. Enemies appended since the last update
+	// are added; if the list shrank without Remap() the index starts over.
+	void Update(const std::vector<Entity>& rEnemies, const RouteMap& rRouteMap);
+
+	// After enemies were erased, keeping their order: pNewIndices[old index] is where each one went, -1 if removed
+	void Remap(const int* pNewIndices);
+
+	bool IsEmpty() const { return m_Order.empty(); }
+	int GetFirst() const { return m_Order.front().iEnemy; } // Closest to its exit
+	int GetLast() const { return m_Order.back().iEnemy; }
+	int GetStrongest() const { return m_iStrongest; } // Most health, the one further along on ties
+
+private:
+	struct Entry {
+		int iEnemy;
+		float fRemainingDistance;
+	};
+
+	std::vector<Entry> m_Order; // Nearest the exit first
+	int m_iTrackedCount = 0; // Enemies below this index are already in m_Order
+	int m_iStrongest = -1;
+};
+
+#endif // !PATHPROGRESSINDEX
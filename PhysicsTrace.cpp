@@ -0,0 +1,104 @@
+#include "PhysicsTrace.h"
+#include <algorithm>
+#include <sstream>
+#include <cmath>
+
+void PhysicsTrace::Clear() {
+	m_Contacts.clear();
+	m_CollisionEvents.clear();
+	m_Bodies.clear();
+}
+
+void PhysicsTrace::AddContact(int iFirst, int iSecond) {
+	m_Contacts.push_back(MakePair(iFirst, iSecond));
+}
+
+void PhysicsTrace::AddCollisionEvent(int iFirst, int iSecond) {
+	m_CollisionEvents.push_back(MakePair(iFirst, iSecond));
+}
+
+void PhysicsTrace::AddBody(const char* pKind, int iIndex, const sf::Vector2f& vPosition, bool bDeletionRequested) {
+	m_Bodies.push_back({ pKind, iIndex, vPosition, bDeletionRequested });
+}
+
+std::string PhysicsTrace::FindDivergence(const PhysicsTrace& rOptimized, const PhysicsTrace& rReference, float fTolerance) {
+	if (rOptimized.m_Bodies.size() != rReference.m_Bodies.size()) {
+		std::ostringstream description;
+		description << "the optimized run ended with " << rOptimized.m_Bodies.size() << " bodies, the reference with " << rReference.m_Bodies.size();
+		return description.str();
+	}
+
+	// A pair found twice is still one contact, but both bodies hearing about it twice is a bug
+	std::string divergence = FindPairDivergence("contact", Sorted(rOptimized.m_Contacts, true), Sorted(rReference.m_Contacts, true), rReference);
+	if (!divergence.empty()) return divergence;
+	divergence = FindPairDivergence("collision event", Sorted(rOptimized.m_CollisionEvents, false), Sorted(rReference.m_CollisionEvents, false), rReference);
+	if (!divergence.empty()) return divergence;
+
+	for (int i = 0; i < static_cast<int>(rReference.m_Bodies.size()); i++) {
+		const Body& rOptimizedBody = rOptimized.m_Bodies[i];
+		const Body& rReferenceBody = rReference.m_Bodies[i];
+		std::ostringstream description;
+		if (rOptimizedBody.bDeletionRequested != rReferenceBody.bDeletionRequested) {
+			description << rReference.DescribeBody(i) << " was " << (rOptimizedBody.bDeletionRequested ? "" : "not ")
+				<< "removed by the optimized run but " << (rReferenceBody.bDeletionRequested ? "" : "not ") << "by the reference";
+			return description.str();
+		}
+		const sf::Vector2f vOffset = rOptimizedBody.vPosition - rReferenceBody.vPosition;
+		if (std::abs(vOffset.x) > fTolerance || std::abs(vOffset.y) > fTolerance) {
+			description << rReference.DescribeBody(i) << " ended at (" << rOptimizedBody.vPosition.x << ", " << rOptimizedBody.vPosition.y
+				<< ") in the optimized run and (" << rReferenceBody.vPosition.x << ", " << rReferenceBody.vPosition.y << ") in the reference";
+			return description.str();
+		}
+	}
+	return std::string();
+}
+
+PhysicsTrace::Pair PhysicsTrace::MakePair(int iFirst, int iSecond) {
+	return iFirst < iSecond ? Pair(iFirst, iSecond) : Pair(iSecond, iFirst);
+}
+
+std::vector<PhysicsTrace::Pair> PhysicsTrace::Sorted(const std::vector<Pair>& rPairs, bool bUnique) {
+	std::vector<Pair> sorted = rPairs;
+	std::sort(sorted.begin(), sorted.end());
+	if (bUnique) {
+		sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+	}
+	return sorted;
+}
+
+std::string PhysicsTrace::FindPairDivergence(const char* pWhat, const std::vector<Pair>& rOptimized, const std::vector<Pair>& rReference, const PhysicsTrace& rNames) {
+	// Both are sorted, walk them together to the first pair only one of them has
+	const int iOptimizedCount = static_cast<int>(rOptimized.size());
+	const int iReferenceCount = static_cast<int>(rReference.size());
+	int iOptimized = 0;
+	int iReference = 0;
+	while (iOptimized < iOptimizedCount || iReference < iReferenceCount) {
+		const bool bOptimizedLeft = iOptimized < iOptimizedCount;
+		const bool bReferenceLeft = iReference < iReferenceCount;
+		if (bOptimizedLeft && bReferenceLeft && rOptimized[iOptimized] == rReference[iReference]) {
+			iOptimized++;
+			iReference++;
+			continue;
+		}
+
+		const bool bOnlyOptimized = !bReferenceLeft || (bOptimizedLeft && rOptimized[iOptimized] < rReference[iReference]);
+		const Pair& rPair = bOnlyOptimized ? rOptimized[iOptimized] : rReference[iReference];
+		std::ostringstream description;
+		description << pWhat << " between " << rNames.DescribeBody(rPair.first) << " and " << rNames.DescribeBody(rPair.second)
+			<< " only in the " << (bOnlyOptimized ? "optimized run" : "reference");
+		return description.str();
+	}
+	return std::string();
+}
+
+std::string PhysicsTrace::DescribeBody(int iBody) const {
+	std::ostringstream description;
+	if (iBody < 0) {
+		description << "wall " << -1 - iBody;
+	} else if (iBody < static_cast<int>(m_Bodies.size())) {
+		description << m_Bodies[iBody].pKind << " " << m_Bodies[iBody].iIndex;
+	} else {
+		description << "body " << iBody;
+	}
+	return description.str();
+}
@@ -0,0 +1,48 @@
+#ifndef PHYSICSTRACE
+#define PHYSICSTRACE
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <string>
+#include <utility>
+
+// What one physics update did, kept so two implementations of it can be held up against each other.
+// Bodies are numbered in the order the update walks them, towers then enemies then axes.
+// Walls are numbered -1 - their index in the wall map.
+class PhysicsTrace {
+public:
+	typedef std::pair<int, int> Pair;
+
+	void Clear();
+
+	// An overlap the narrowphase found, including ones found again on a later sub-step
+	void AddContact(int iFirst, int iSecond);
+	// The first overlap of a pair, when both bodies were told about it
+	void AddCollisionEvent(int iFirst, int iSecond);
+	// Where a body ended up, added in body order once the update is done
+	void AddBody(const char* pKind, int iIndex, const sf::Vector2f& vPosition, bool bDeletionRequested);
+
+	// The first way the two runs disagree, in words, or empty when they agree.
+	// The order pairs were found in doesn't matter, positions may be up to fTolerance apart.
+	static std::string FindDivergence(const PhysicsTrace& rOptimized, const PhysicsTrace& rReference, float fTolerance);
+
+private:
+	struct Body {
+		const char* pKind;
+		int iIndex; // Within its own list
+		sf::Vector2f vPosition;
+		bool bDeletionRequested;
+	};
+
+	static Pair MakePair(int iFirst, int iSecond);
+	// Pairs sorted, with the repeats dropped when bUnique is set
+	static std::vector<Pair> Sorted(const std::vector<Pair>& rPairs, bool bUnique);
+	static std::string FindPairDivergence(const char* pWhat, const std::vector<Pair>& rOptimized, const std::vector<Pair>& rReference, const PhysicsTrace& rNames);
+	std::string DescribeBody(int iBody) const;
+
+	std::vector<Pair> m_Contacts;
+	std::vector<Pair> m_CollisionEvents;
+	std::vector<Body> m_Bodies;
+};
+
+#endif // !PHYSICSTRACE
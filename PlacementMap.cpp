@@ -0,0 +1,69 @@
+#include "PlacementMap.h"
+#include <cmath>
+#include <algorithm>
+
+PlacementMap::PlacementMap(float fCellSize)
+	: m_fCellSize(fCellSize)
+	, m_iWidth(0)
+	, m_iHeight(0)
+	, m_TowerGrid(fCellSize, 256)
+{}
+
+void PlacementMap::SetBuildable(const sf::Vector2i& vCell, bool bBuildable) {
+	if (vCell.x < 0 || vCell.y < 0) return;
+
+	if (vCell.x >= m_iWidth || vCell.y >= m_iHeight) {
+		if (!bBuildable) return; // Outside the map is already unbuildable
+
+		// Grow the bitmap, copying the old rows into the wider layout
+		const int iNewWidth = std::max(m_iWidth, vCell.x + 1);
+		const int iNewHeight = std::max(m_iHeight, vCell.y + 1);
+		std::vector<std::uint8_t> newBuildable(iNewWidth * iNewHeight, 0);
+		for (int y = 0; y < m_iHeight; y++) {
+			for (int x = 0; x < m_iWidth; x++) {
+				newBuildable[y * iNewWidth + x] = m_Buildable[y * m_iWidth + x];
+			}
+		}
+		m_Buildable.swap(newBuildable);
+		m_iWidth = iNewWidth;
+		m_iHeight = iNewHeight;
+	}
+	m_Buildable[vCell.y * m_iWidth + vCell.x] = bBuildable ? 1 : 0;
+}
+
+bool PlacementMap::IsBuildable(const sf::Vector2f& vPosition) const {
+	const int x = static_cast<int>(std::floor(vPosition.x / m_fCellSize));
+	const int y = static_cast<int>(std::floor(vPosition.y / m_fCellSize));
+	if (x < 0 || y < 0 || x >= m_iWidth || y >= m_iHeight) return false;
+	return m_Buildable[y * m_iWidth + x] != 0;
+}
+
+void PlacementMap::AddTower(const sf::Vector2f& vPosition) {
+	m_TowerPositions.push_back(vPosition);
+
+	// Towers are placed rarely, so just rebuild the lookup
+	m_TowerGrid.Clear();
+	for (int i = 0; i < static_cast<int>(m_TowerPositions.size()); i++) {
+		m_TowerGrid.Insert(i, m_TowerPositions[i]);
+	}
+	m_TowerGrid.Build();
+}
+
+void PlacementMap::ClearTowers() {
+	m_TowerPositions.clear();
+	m_TowerGrid.Clear();
+	m_TowerGrid.Build();
+}
+
+bool PlacementMap::OverlapsTower(const sf::Vector2f& vPosition, float fMinDistance) const {
+	bool bOverlaps = false;
+	m_TowerGrid.ForEachNear(vPosition, fMinDistance, [&](int iTower) {
+		const sf::Vector2f vOffset = m_TowerPositions[iTower] - vPosition;
+		if (vOffset.x * vOffset.x + vOffset.y * vOffset.y < fMinDistance * fMinDistance) {
+			bOverlaps = true;
+			return false;
+		}
+		return true;
+	});
+	return bOverlaps;
+}
@@ -0,0 +1,35 @@
+#ifndef PLACEMENTMAP
+#define PLACEMENTMAP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+#include "SpatialGrid.h"
+
+// Answers "can a tower go here" without looking at every tile and tower.
+// Kept up to date as tiles and towers change, so a query is a bitmap read plus a few neighbours.
+class PlacementMap {
+public:
+	PlacementMap(float fCellSize);
+
+	void SetBuildable(const sf::Vector2i& vCell, bool bBuildable);
+	bool IsBuildable(const sf::Vector2f& vPosition) const;
+
+	void AddTower(const sf::Vector2f& vPosition);
+	void ClearTowers();
+	// True when any tower is closer than fMinDistance
+	bool OverlapsTower(const sf::Vector2f& vPosition, float fMinDistance) const;
+
+private:
+	float m_fCellSize;
+
+	// One byte per cell, grown to fit the furthest buildable cell
+	std::vector<std::uint8_t> m_Buildable;
+	int m_iWidth;
+	int m_iHeight;
+
+	std::vector<sf::Vector2f> m_TowerPositions;
+	SpatialGrid m_TowerGrid;
+};
+
+#endif // !PLACEMENTMAP
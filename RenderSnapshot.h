@@ -0,0 +1,53 @@
+#ifndef RENDERSNAPSHOT
+#define RENDERSNAPSHOT
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Entity.h"
+#include "DamageTextManager.h"
+
+// Everything the render thread needs to draw one simulation tick. The simulation fills one
+// in at the end of every tick, and nothing in it points at state the simulation changes later.
+struct RenderSnapshot {
+	// One entity as it looked this tick. Prototypes never change once the game is set up.
+	struct Item {
+		const Entity::Prototype* pPrototype;
+		sf::Vector2f vPosition;
+		float fRotation;
+		sf::Color color;
+
+		void Draw(sf::RenderTarget& rRenderTarget) const {
+			Entity::DrawAppearance(rRenderTarget, sf::RenderStates::Default, *pPrototype, vPosition, fRotation, color);
+		}
+	};
+
+	static Item MakeItem(const Entity& rEntity) {
+		Item item;
+		item.pPrototype = &rEntity.GetPrototype();
+		item.vPosition = rEntity.GetPosition();
+		item.fRotation = rEntity.GetRotation();
+		item.color = rEntity.GetColor();
+		return item;
+	}
+
+	std::vector<Item> Tiles; // Always drawn, under everything else
+	std::vector<Item> RouteTiles; // Spawns, exits and paths, only shown in the level editor
+	std::vector<Item> Entities; // Towers, enemies and axes, in draw order
+	std::vector<DamageTextManager::DamageText> DamageTexts;
+
+	bool bLevelEditor = false;
+	unsigned int uSceneRevision = 0; // Same number, same picture, while in the editor or game over
+	sf::Vector2f vMousePosition;
+	bool bCanPlaceTower = false; // Colours the placement preview under the mouse
+	int iTileOption = 0;
+
+	// HUD
+	float fDifficulty = 0.0f;
+	int iPlayerGold = 0;
+	float fGoldPerSecond = 0.0f;
+	bool bPlacingSplashTower = false;
+	int iHoveredTowerMode = -1; // Targeting mode of the tower under the mouse, if there is one
+	bool bGameOver = false;
+};
+
+#endif // !RENDERSNAPSHOT
@@ -0,0 +1,201 @@
+#include "RouteMap.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+RouteMap::RouteMap(float fCellSize)
+	: m_fCellSize(fCellSize)
+	, m_iWidth(0)
+	, m_iHeight(0)
+{}
+
+void RouteMap::Clear() {
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_Walkable.clear();
+	m_Exits.clear();
+	m_Distances.clear();
+	m_NextCells.clear();
+	m_ReturnDistances.clear();
+	m_ReturnCells.clear();
+	m_Spawns.clear();
+}
+
+void RouteMap::Build(const std::vector<sf::Vector2i>& rWalkableCells, const std::vector<sf::Vector2i>& rSpawnCells,
+	const std::vector<sf::Vector2i>& rExitCells) {
+	Clear();
+
+	for (const sf::Vector2i& vCell : rWalkableCells) {
+		if (vCell.x < 0 || vCell.y < 0) continue;
+		m_iWidth = std::max(m_iWidth, vCell.x + 1);
+		m_iHeight = std::max(m_iHeight, vCell.y + 1);
+	}
+	if (m_iWidth == 0 || m_iHeight == 0) return;
+
+	const int iCellCount = m_iWidth * m_iHeight;
+	m_Walkable.assign(iCellCount, 0);
+	for (const sf::Vector2i& vCell : rWalkableCells) {
+		const int iCell = GetCellIndex(vCell);
+		if (iCell >= 0) m_Walkable[iCell] = 1;
+	}
+
+	for (const sf::Vector2i& vCell : rExitCells) {
+		if (GetCellIndex(vCell) >= 0) m_Exits.push_back(vCell);
+	}
+
+	// One flood out from each exit, along the walkable cells only
+	m_Distances.assign(m_Exits.size() * iCellCount, -1);
+	m_NextCells.assign(m_Exits.size() * iCellCount, -1);
+	std::vector<int> sources(1);
+	for (int iExit = 0; iExit < GetExitCount(); iExit++) {
+		sources[0] = GetCellIndex(m_Exits[iExit]);
+		FloodFill(sources, true, &m_Distances[iExit * iCellCount], &m_NextCells[iExit * iCellCount]);
+	}
+
+	// Everything that isn't walkable floods back towards the nearest walkable cell
+	sources.clear();
+	for (int iCell = 0; iCell < iCellCount; iCell++) {
+		if (m_Walkable[iCell]) sources.push_back(iCell);
+	}
+	m_ReturnDistances.assign(iCellCount, -1);
+	m_ReturnCells.assign(iCellCount, -1);
+	FloodFill(sources, false, m_ReturnDistances.data(), m_ReturnCells.data());
+
+	for (const sf::Vector2i& vCell : rSpawnCells) {
+		const int iExit = FindNearestExit(GetCellCenter(vCell));
+		if (iExit < 0) continue; // Nothing reachable from this spawn
+
+		Spawn spawn;
+		spawn.vCell = vCell;
+		spawn.iExit = iExit;
+		m_Spawns.push_back(spawn);
+	}
+}
+
+void RouteMap::FloodFill(const std::vector<int>& rSources, bool bWalkable, int* pDistances, int* pNextCells) {
+	m_Queue.clear();
+	for (int iSource : rSources) {
+		pDistances[iSource] = 0;
+		pNextCells[iSource] = iSource;
+		m_Queue.push_back(iSource);
+	}
+
+	const int iOffsets[4][2] = { {0, -1}, {1, 0}, {0, 1}, {-1, 0} };
+	for (int iHead = 0; iHead < static_cast<int>(m_Queue.size()); iHead++) {
+		const int iCell = m_Queue[iHead];
+		const int x = iCell % m_iWidth;
+		const int y = iCell / m_iWidth;
+
+		for (const int* pOffset : iOffsets) {
+			const int iNeighbour = GetCellIndex(sf::Vector2i(x + pOffset[0], y + pOffset[1]));
+			if (iNeighbour < 0 || pDistances[iNeighbour] >= 0) continue;
+			if ((m_Walkable[iNeighbour] != 0) != bWalkable) continue;
+
+			// The first cell to reach a neighbour is one of its closest, so that is where it steps next
+			pDistances[iNeighbour] = pDistances[iCell] + 1;
+			pNextCells[iNeighbour] = iCell;
+			m_Queue.push_back(iNeighbour);
+		}
+	}
+}
+
+int RouteMap::FindNearestExit(const sf::Vector2f& vPosition) const {
+	const int iCell = GetCellIndex(vPosition);
+	if (iCell < 0) return -1;
+
+	const int iCellCount = m_iWidth * m_iHeight;
+	int iNearestExit = -1;
+	for (int iExit = 0; iExit < GetExitCount(); iExit++) {
+		const int iDistance = m_Distances[iExit * iCellCount + iCell];
+		if (iDistance < 0) continue;
+		if (iNearestExit < 0 || iDistance < m_Distances[iNearestExit * iCellCount + iCell]) {
+			iNearestExit = iExit;
+		}
+	}
+	return iNearestExit;
+}
+
+bool RouteMap::GetNextWaypoint(int iExit, const sf::Vector2f& vPosition, sf::Vector2f& rWaypoint) const {
+	if (iExit < 0 || iExit >= GetExitCount()) return false;
+
+	const int iCell = GetRouteCell(vPosition);
+	if (!m_Walkable[iCell]) {
+		if (m_ReturnCells[iCell] < 0) return false;
+		rWaypoint = GetCellCenter(m_ReturnCells[iCell]);
+		return true;
+	}
+
+	const int iNextCell = m_NextCells[iExit * m_iWidth * m_iHeight + iCell];
+	if (iNextCell < 0) return false;
+	rWaypoint = GetCellCenter(iNextCell);
+	return true;
+}
+
+float RouteMap::GetRemainingDistance(int iExit, const sf::Vector2f& vPosition) const {
+	if (iExit < 0 || iExit >= GetExitCount()) return std::numeric_limits<float>::infinity();
+
+	const int x = std::clamp(static_cast<int>(std::floor(vPosition.x / m_fCellSize)), 0, m_iWidth - 1);
+	const int y = std::clamp(static_cast<int>(std::floor(vPosition.y / m_fCellSize)), 0, m_iHeight - 1);
+	int iCell = y * m_iWidth + x;
+
+	// Off the route, head straight back to wherever the return field leads
+	const bool bOffRoute = !m_Walkable[iCell];
+	while (!m_Walkable[iCell]) {
+		if (m_ReturnCells[iCell] < 0) return std::numeric_limits<float>::infinity();
+		iCell = m_ReturnCells[iCell];
+	}
+
+	const int iFieldOffset = iExit * m_iWidth * m_iHeight;
+	const int iDistance = m_Distances[iFieldOffset + iCell];
+	if (iDistance < 0) return std::numeric_limits<float>::infinity();
+
+	// Straight to the next cell centre, then a whole cell per step after that
+	const int iNextCell = bOffRoute ? iCell : m_NextCells[iFieldOffset + iCell];
+	const int iStepsAfterNext = bOffRoute ? iDistance : std::max(iDistance - 1, 0);
+	const sf::Vector2f vToNext = GetCellCenter(iNextCell) - vPosition;
+	return std::sqrt(vToNext.x * vToNext.x + vToNext.y * vToNext.y) + iStepsAfterNext * m_fCellSize;
+}
+
+bool RouteMap::IsNearExit(int iExit, const sf::Vector2f& vPosition, float fDistance) const {
+	if (iExit < 0 || iExit >= GetExitCount()) return false;
+	const sf::Vector2f vOffset = GetCellCenter(m_Exits[iExit]) - vPosition;
+	return vOffset.x * vOffset.x + vOffset.y * vOffset.y < fDistance * fDistance;
+}
+
+int RouteMap::GetDistance(int iExit, const sf::Vector2i& vCell) const {
+	const int iCell = GetCellIndex(vCell);
+	if (iExit < 0 || iExit >= GetExitCount() || iCell < 0) return -1;
+	return m_Distances[iExit * m_iWidth * m_iHeight + iCell];
+}
+
+int RouteMap::GetRouteCell(const sf::Vector2f& vPosition) const {
+	if (m_Walkable.empty()) return -1;
+
+	// Anything pushed off the edge of the grid walks back in from the nearest border cell
+	const int x = std::clamp(static_cast<int>(std::floor(vPosition.x / m_fCellSize)), 0, m_iWidth - 1);
+	const int y = std::clamp(static_cast<int>(std::floor(vPosition.y / m_fCellSize)), 0, m_iHeight - 1);
+	return y * m_iWidth + x;
+}
+
+bool RouteMap::IsWalkable(const sf::Vector2i& vCell) const {
+	const int iCell = GetCellIndex(vCell);
+	return iCell >= 0 && m_Walkable[iCell] != 0;
+}
+
+int RouteMap::GetCellIndex(const sf::Vector2i& vCell) const {
+	if (vCell.x < 0 || vCell.y < 0 || vCell.x >= m_iWidth || vCell.y >= m_iHeight) return -1;
+	return vCell.y * m_iWidth + vCell.x;
+}
+
+int RouteMap::GetCellIndex(const sf::Vector2f& vPosition) const {
+	return GetCellIndex(sf::Vector2i(static_cast<int>(std::floor(vPosition.x / m_fCellSize)),
+		static_cast<int>(std::floor(vPosition.y / m_fCellSize))));
+}
+
+sf::Vector2f RouteMap::GetCellCenter(const sf::Vector2i& vCell) const {
+	return sf::Vector2f((vCell.x + 0.5f) * m_fCellSize, (vCell.y + 0.5f) * m_fCellSize);
+}
+
+sf::Vector2f RouteMap::GetCellCenter(int iCell) const {
+	return GetCellCenter(sf::Vector2i(iCell % m_iWidth, iCell / m_iWidth));
+}
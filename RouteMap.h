@@ -0,0 +1,79 @@
+#ifndef ROUTEMAP
+#define ROUTEMAP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+
+// Routes enemies from any spawn to any exit over the walkable tiles.
+// Every exit gets a distance field over the tile grid, built once per layout, so following
+// a route is one table lookup per enemy per tick no matter how many lanes the level has.
+class RouteMap {
+public:
+	RouteMap(float fCellSize);
+
+	// Walkable cells are the spawns, exits and path tiles together
+	void Build(const std::vector<sf::Vector2i>& rWalkableCells, const std::vector<sf::Vector2i>& rSpawnCells,
+		const std::vector<sf::Vector2i>& rExitCells);
+	void Clear();
+
+	// Spawns that can reach at least one exit, each paired with its nearest exit
+	bool HasRoutes() const { return !m_Spawns.empty(); }
+	int GetSpawnCount() const { return static_cast<int>(m_Spawns.size()); }
+	sf::Vector2f GetSpawnPosition(int iSpawn) const { return GetCellCenter(m_Spawns[iSpawn].vCell); }
+	int GetSpawnExit(int iSpawn) const { return m_Spawns[iSpawn].iExit; }
+	int GetExitCount() const { return static_cast<int>(m_Exits.size()); }
+
+	// Closest reachable exit from here, or -1 when none can be reached
+	int FindNearestExit(const sf::Vector2f& vPosition) const;
+
+	// Where to head next on the way to iExit. Off the route this leads back onto it.
+	// False when there is no way to the exit from here.
+	bool GetNextWaypoint(int iExit, const sf::Vector2f& vPosition, sf::Vector2f& rWaypoint) const;
+	bool IsNearExit(int iExit, const sf::Vector2f& vPosition, float fDistance) const;
+
+	// How far there is left to walk to iExit along the route, in world units.
+	// Off the route this includes the way back onto it. Infinite when there is no way.
+	float GetRemainingDistance(int iExit, const sf::Vector2f& vPosition) const;
+
+	// Steps from this cell to the exit, -1 when it is unreachable or not walkable
+	int GetDistance(int iExit, const sf::Vector2i& vCell) const;
+	bool IsWalkable(const sf::Vector2i& vCell) const;
+	// The cell GetNextWaypoint() steers from here, -1 before the first build.
+	// The waypoint only changes when this does.
+	int GetRouteCell(const sf::Vector2f& vPosition) const;
+
+private:
+	struct Spawn {
+		sf::Vector2i vCell;
+		int iExit;
+	};
+
+	int GetCellIndex(const sf::Vector2i& vCell) const;
+	int GetCellIndex(const sf::Vector2f& vPosition) const;
+	sf::Vector2f GetCellCenter(const sf::Vector2i& vCell) const;
+	sf::Vector2f GetCellCenter(int iCell) const;
+
+	// Breadth first from every source at once, filling pDistances and pointing pNextCells
+	// at the neighbour one step closer to a source
+	void FloodFill(const std::vector<int>& rSources, bool bWalkable, int* pDistances, int* pNextCells);
+
+	float m_fCellSize;
+	int m_iWidth;
+	int m_iHeight;
+	std::vector<std::uint8_t> m_Walkable;
+
+	std::vector<sf::Vector2i> m_Exits;
+	// One field per exit, m_Exits.size() * width * height entries
+	std::vector<int> m_Distances;
+	std::vector<int> m_NextCells;
+
+	// For cells off the route, the neighbour leading back to the nearest walkable cell
+	std::vector<int> m_ReturnDistances;
+	std::vector<int> m_ReturnCells;
+
+	std::vector<Spawn> m_Spawns;
+	std::vector<int> m_Queue;
+};
+
+#endif // !ROUTEMAP
@@ -0,0 +1,39 @@
+#include "SimulationSnapshot.h"
+#include <cstring>
+#include <fstream>
+
+void SimulationSnapshot::Append(const void* pData, std::size_t iBytes) {
+	if (iBytes == 0) return;
+	std::memcpy(Extend(iBytes), pData, iBytes);
+}
+
+void* SimulationSnapshot::Extend(std::size_t iBytes) {
+	const std::size_t iOffset = m_Bytes.size();
+	m_Bytes.resize(iOffset + iBytes);
+	return m_Bytes.data() + iOffset;
+}
+
+const void* SimulationSnapshot::Read(std::size_t& rOffset, std::size_t iBytes) const {
+	if (rOffset + iBytes > m_Bytes.size()) return nullptr;
+	const void* pData = m_Bytes.data() + rOffset;
+	rOffset += iBytes;
+	return pData;
+}
+
+bool SimulationSnapshot::SaveToFile(const std::string& rFileName) const {
+	std::ofstream file(rFileName, std::ios::binary);
+	if (!file) return false;
+	file.write(reinterpret_cast<const char*>(m_Bytes.data()), m_Bytes.size());
+	return static_cast<bool>(file);
+}
+
+bool SimulationSnapshot::LoadFromFile(const std::string& rFileName) {
+	std::ifstream file(rFileName, std::ios::binary | std::ios::ate);
+	if (!file) return false;
+
+	const std::streamsize iSize = file.tellg();
+	file.seekg(0);
+	m_Bytes.resize(static_cast<std::size_t>(iSize));
+	file.read(reinterpret_cast<char*>(m_Bytes.data()), iSize);
+	return static_cast<bool>(file);
+}
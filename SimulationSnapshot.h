@@ -0,0 +1,75 @@
+#ifndef SIMULATIONSNAPSHOT
+#define SIMULATIONSNAPSHOT
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// The whole state of a running match as one flat, pointer-free block of bytes: a fixed
+// header followed by plain arrays. Capturing and restoring are bulk copies, so a match can be
+// captured every tick for rewinding, or saved to disk and loaded to start a benchmark late game.
+class SimulationSnapshot {
+public:
+	static constexpr std::uint32_t Magic = 0x53534454; // "TDSS"
+	// Bump whenever Header or any stored array changes layout
+	static constexpr std::uint32_t Version = 7;
+
+	static_assert(std::is_trivially_copyable<std::mt19937>::value, "The random generator is stored bytewise");
+
+	// Counts of the arrays that follow, then every scalar the simulation keeps between ticks
+	struct Header {
+		std::uint32_t uMagic;
+		std::uint32_t uVersion;
+		std::uint32_t uHeaderSize;
+		std::uint32_t uEntityStateSize;
+		std::uint64_t uLayoutHash; // Only restored onto the same tiles
+
+		std::uint32_t uTowerCount;
+		std::uint32_t uEnemyCount;
+		std::uint32_t uAxeCount;
+		std::uint32_t uDamageTextCount;
+
+		int iPlayerHealth;
+		int iPlayerGold;
+		int iGoldGainedThisUpdate;
+		float fTimeInPlayMode;
+		float fDifficulty;
+		float fGoldPerSecond;
+		float fGoldPerSecondTimer;
+		float fSpawnTimer;
+		int iEnemiesSpawned;
+		int iAxesThrown;
+		int iEnemiesKilled;
+		int iEnemiesLeaked;
+		int iGoldEarned;
+		int iTimerTick;
+		float fTimerRemainder;
+		int iSteeringCursor;
+		int iAxeSpinCursor;
+
+		std::mt19937 rng;
+	};
+
+	// Writing. Clear() keeps the buffer, so capturing every tick stops allocating once it has grown.
+	void Clear() { m_Bytes.clear(); }
+	void Append(const void* pData, std::size_t iBytes);
+	// Room for iBytes more at the end, for the caller to fill in
+	void* Extend(std::size_t iBytes);
+
+	// Reading walks the buffer from the front. Null if the buffer is too short.
+	const void* Read(std::size_t& rOffset, std::size_t iBytes) const;
+
+	bool IsEmpty() const { return m_Bytes.empty(); }
+	std::size_t GetSize() const { return m_Bytes.size(); }
+
+	bool SaveToFile(const std::string& rFileName) const;
+	bool LoadFromFile(const std::string& rFileName);
+
+private:
+	std::vector<unsigned char> m_Bytes;
+};
+
+#endif // !SIMULATIONSNAPSHOT
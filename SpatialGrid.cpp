@@ -0,0 +1,54 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cassert>
+
+SpatialGrid::SpatialGrid(float fCellSize, int iBucketCount)
+	: m_fCellSize(fCellSize)
+	, m_BucketStarts(iBucketCount + 1, 0)
+{
+	// The bucket mask only works for powers of two
+	assert(iBucketCount > 0 && (iBucketCount & (iBucketCount - 1)) == 0);
+}
+
+void SpatialGrid::Clear() {
+	m_Pending.clear();
+	m_Items.clear();
+	std::fill(m_BucketStarts.begin(), m_BucketStarts.end(), 0);
+}
+
+void SpatialGrid::Insert(int iIndex, const sf::Vector2f& vPosition) {
+	Item item;
+	item.iIndex = iIndex;
+	item.iCellX = GetCell(vPosition.x);
+	item.iCellY = GetCell(vPosition.y);
+	m_Pending.push_back(item);
+}
+
+void SpatialGrid::Build() {
+	// Counting sort: count each bucket, turn the counts into start offsets, then scatter
+	std::fill(m_BucketStarts.begin(), m_BucketStarts.end(), 0);
+	for (const Item& rItem : m_Pending) {
+		m_BucketStarts[GetBucket(rItem.iCellX, rItem.iCellY) + 1]++;
+	}
+
+	for (size_t i = 1; i < m_BucketStarts.size(); i++) {
+		m_BucketStarts[i] += m_BucketStarts[i - 1];
+	}
+
+	// Resizing up from empty would allocate an exact fit, and again for every new high
+	if (m_Items.capacity() < m_Pending.size()) {
+		m_Items.reserve(m_Pending.capacity());
+	}
+	m_Items.resize(m_Pending.size());
+	for (const Item& rItem : m_Pending) {
+		// The bucket start is used as a write cursor, afterwards it points at the next bucket
+		int& rCursor = m_BucketStarts[GetBucket(rItem.iCellX, rItem.iCellY)];
+		m_Items[rCursor++] = rItem;
+	}
+
+	// Every cursor moved forward by one bucket, shift them back into place
+	for (size_t i = m_BucketStarts.size() - 1; i > 0; i--) {
+		m_BucketStarts[i] = m_BucketStarts[i - 1];
+	}
+	m_BucketStarts[0] = 0;
+}
@@ -0,0 +1,67 @@
+#ifndef SPATIALGRID
+#define SPATIALGRID
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cmath>
+
+// Buckets indices by the grid cell their position falls in, so neighbours can be found
+// without looking at everything. Cells are hashed into a fixed number of buckets, so the
+// grid works for any world size and needs no allocations once it has warmed up.
+class SpatialGrid {
+public:
+	SpatialGrid(float fCellSize, int iBucketCount = 4096);
+
+	void Clear();
+	void Insert(int iIndex, const sf::Vector2f& vPosition);
+	// Sorts everything inserted since the last Clear() into its bucket, call before querying
+	void Build();
+
+	// Calls fn(index) for everything in the cells touched by the circle, until fn returns false.
+	// Entries near the circle but outside it are included, callers do their own exact test.
+	template <typename Fn>
+	void ForEachNear(const sf::Vector2f& vPosition, float fRadius, Fn fn) const {
+		const int iMinX = GetCell(vPosition.x - fRadius);
+		const int iMaxX = GetCell(vPosition.x + fRadius);
+		const int iMinY = GetCell(vPosition.y - fRadius);
+		const int iMaxY = GetCell(vPosition.y + fRadius);
+
+		for (int y = iMinY; y <= iMaxY; y++) {
+			for (int x = iMinX; x <= iMaxX; x++) {
+				const int iBucket = GetBucket(x, y);
+				for (int i = m_BucketStarts[iBucket]; i < m_BucketStarts[iBucket + 1]; i++) {
+					const Item& rItem = m_Items[i];
+					// Other cells can hash into the same bucket
+					if (rItem.iCellX != x || rItem.iCellY != y) continue;
+					if (!fn(rItem.iIndex)) return;
+				}
+			}
+		}
+	}
+
+	float GetCellSize() const { return m_fCellSize; }
+	int GetCount() const { return static_cast<int>(m_Items.size()); }
+
+private:
+	struct Item {
+		int iIndex;
+		int iCellX;
+		int iCellY;
+	};
+
+	int GetCell(float fCoordinate) const {
+		return static_cast<int>(std::floor(fCoordinate / m_fCellSize));
+	}
+
+	int GetBucket(int iCellX, int iCellY) const {
+		const unsigned int uHash = static_cast<unsigned int>(iCellX) * 73856093u ^ static_cast<unsigned int>(iCellY) * 19349663u;
+		return static_cast<int>(uHash & (m_BucketStarts.size() - 2));
+	}
+
+	float m_fCellSize;
+	std::vector<Item> m_Pending;
+	std::vector<Item> m_Items; // Sorted by bucket after Build()
+	std::vector<int> m_BucketStarts; // One past the bucket count, the last entry is the end
+};
+
+#endif // !SPATIALGRID
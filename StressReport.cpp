@@ -0,0 +1,147 @@
+#include "StressReport.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+StressReport::StressReport() {
+	Reset();
+}
+
+void StressReport::Reset() {
+	m_iTicks = 0;
+	for (int i = 0; i < NumPhases; i++) {
+		m_fPhaseTotalSeconds[i] = 0.0f;
+		m_fPhaseMaxSeconds[i] = 0.0f;
+		m_fTickSeconds[i] = 0.0f;
+	}
+	m_fLastTickSeconds = 0.0f;
+	m_fMaxTickSeconds = 0.0f;
+	m_iEnemies = 0;
+	m_iAxes = 0;
+	m_iTowers = 0;
+	m_iPeakEnemies = 0;
+	m_iPeakAxes = 0;
+	m_iPeakEntityBytes = 0;
+	m_iBytesPerEntity = 0;
+	m_iBytesPerPrototype = 0;
+	m_iStorageReallocations = 0;
+	m_iSpawns = 0;
+	m_iFrameArenaPeakBytes = 0;
+	m_iFrameArenaOverflows = 0;
+}
+
+void StressReport::AddPhaseTime(Phase ePhase, const sf::Time& rTime) {
+	m_fTickSeconds[ePhase] += rTime.asSeconds();
+}
+
+void StressReport::EndTick(int iEnemies, int iAxes, int iTowers, std::size_t iEntityBytes) {
+	m_fLastTickSeconds = 0.0f;
+	for (int i = 0; i < NumPhases; i++) {
+		m_fPhaseTotalSeconds[i] += m_fTickSeconds[i];
+		m_fPhaseMaxSeconds[i] = std::max(m_fPhaseMaxSeconds[i], m_fTickSeconds[i]);
+		m_fLastTickSeconds += m_fTickSeconds[i];
+		m_fTickSeconds[i] = 0.0f;
+	}
+	m_fMaxTickSeconds = std::max(m_fMaxTickSeconds, m_fLastTickSeconds);
+
+	m_iEnemies = iEnemies;
+	m_iAxes = iAxes;
+	m_iTowers = iTowers;
+	m_iPeakEnemies = std::max(m_iPeakEnemies, iEnemies);
+	m_iPeakAxes = std::max(m_iPeakAxes, iAxes);
+	m_iPeakEntityBytes = std::max(m_iPeakEntityBytes, iEntityBytes);
+	m_iTicks++;
+}
+
+void StressReport::SetEntityFootprint(std::size_t iBytesPerEntity, std::size_t iBytesPerPrototype) {
+	m_iBytesPerEntity = iBytesPerEntity;
+	m_iBytesPerPrototype = iBytesPerPrototype;
+}
+
+void StressReport::AddStorageReallocation() {
+	m_iStorageReallocations++;
+}
+
+void StressReport::SetSpawnCount(int iSpawns) {
+	m_iSpawns = iSpawns;
+}
+
+void StressReport::SetFrameArenaUsage(std::size_t iPeakBytes, int iOverflows) {
+	m_iFrameArenaPeakBytes = iPeakBytes;
+	m_iFrameArenaOverflows = iOverflows;
+}
+
+void StressReport::PrintProgress(std::ostream& rStream) const {
+	rStream << "tick " << m_iTicks
+		<< "  enemies " << m_iEnemies
+		<< "  axes " << m_iAxes
+		<< "  towers " << m_iTowers
+		<< "  tick ms " << m_fLastTickSeconds * 1000.0f << "\n";
+}
+
+void StressReport::Print(std::ostream& rStream) const {
+	rStream << "Stress report after " << m_iTicks << " ticks\n";
+	rStream << "  phase        avg ms      max ms\n";
+	for (int i = 0; i < NumPhases; i++) {
+		const float fAverage = m_iTicks > 0 ? m_fPhaseTotalSeconds[i] / m_iTicks : 0.0f;
+		rStream << "  " << GetPhaseName(static_cast<Phase>(i))
+			<< "  " << fAverage * 1000.0f
+			<< "  " << m_fPhaseMaxSeconds[i] * 1000.0f << "\n";
+	}
+	rStream << "  slowest tick ms: " << m_fMaxTickSeconds * 1000.0f << "\n";
+	rStream << "  peak enemies: " << m_iPeakEnemies << "\n";
+	rStream << "  peak axes: " << m_iPeakAxes << "\n";
+	rStream << "  peak entity storage KB: " << m_iPeakEntityBytes / 1024 << "\n";
+	rStream << "  bytes per entity: " << m_iBytesPerEntity << " (+" << m_iBytesPerPrototype << " shared per prototype)\n";
+	rStream << "  allocations per spawn: " << (m_iSpawns > 0 ? static_cast<float>(m_iStorageReallocations) / m_iSpawns : 0.0f)
+		<< " (" << m_iStorageReallocations << " storage growths over " << m_iSpawns << " spawns)\n";
+	rStream << "  frame arena peak KB: " << m_iFrameArenaPeakBytes / 1024
+		<< " (outgrown " << m_iFrameArenaOverflows << " times)\n";
+	rStream << "  peak process memory KB: " << GetPeakProcessMemoryBytes() / 1024 << "\n";
+}
+
+std::size_t StressReport::GetPeakProcessMemoryBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // ru_maxrss is in KB
+	}
+	return 0;
+#endif
+}
+
+const char* StressReport::GetPhaseName(Phase ePhase) {
+	switch (ePhase) {
+		case Spawn:
+			return "spawn   ";
+		case Towers:
+			return "towers  ";
+		case Axes:
+			return "axes    ";
+		case Steering:
+			return "steering";
+		case Physics:
+			return "physics ";
+		case Damage:
+			return "damage  ";
+		case Deletion:
+			return "deletion";
+		case Snapshot:
+			return "snapshot";
+		default:
+			return "unknown ";
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef STRESSREPORT
+#define STRESSREPORT
+
+#include <SFML/System/Time.hpp>
+#include <cstddef>
+#include <iostream>
+
+// Collects per-phase timings and memory peaks while the game runs in stress mode
+class StressReport {
+public:
+	enum Phase {
+		Spawn,
+		Towers,
+		Axes,
+		Steering,
+		Physics,
+		Damage,
+		Deletion,
+		Snapshot,
+		NumPhases
+	};
+
+	StressReport();
+
+	void Reset();
+	void AddPhaseTime(Phase ePhase, const sf::Time& rTime);
+	void EndTick(int iEnemies, int iAxes, int iTowers, std::size_t iEntityBytes);
+
+	// How much each spawned entity costs: its own size, the shared data it points at,
+	// and how often spawning had to grow the entity storage
+	void SetEntityFootprint(std::size_t iBytesPerEntity, std::size_t iBytesPerPrototype);
+	void AddStorageReallocation();
+	void SetSpawnCount(int iSpawns);
+	// High water mark of the per-tick scratch arena, and how often a tick outgrew it
+	void SetFrameArenaUsage(std::size_t iPeakBytes, int iOverflows);
+
+	void PrintProgress(std::ostream& rStream) const;
+	void Print(std::ostream& rStream) const;
+
+	int GetTickCount() const { return m_iTicks; }
+
+	// Peak resident memory of the whole process, 0 if the platform can't tell us
+	static std::size_t GetPeakProcessMemoryBytes();
+
+private:
+	static const char* GetPhaseName(Phase ePhase);
+
+	int m_iTicks;
+
+	float m_fPhaseTotalSeconds[NumPhases];
+	float m_fPhaseMaxSeconds[NumPhases];
+	float m_fTickSeconds[NumPhases]; // Phase times of the tick in progress
+
+	float m_fLastTickSeconds;
+	float m_fMaxTickSeconds;
+
+	int m_iEnemies;
+	int m_iAxes;
+	int m_iTowers;
+	int m_iPeakEnemies;
+	int m_iPeakAxes;
+	std::size_t m_iPeakEntityBytes;
+
+	std::size_t m_iBytesPerEntity;
+	std::size_t m_iBytesPerPrototype;
+	int m_iStorageReallocations;
+	int m_iSpawns;
+
+	std::size_t m_iFrameArenaPeakBytes;
+	int m_iFrameArenaOverflows;
+};
+
+#endif // !STRESSREPORT
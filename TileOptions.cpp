@@ -1,5 +1,5 @@
-#include "TileOptions.h"
-
-TileOptions::TileOptions(TileType m_tileType) 
-	: m_tileType(m_tileType) 
+#include "TileOptions.h"
+
+TileOptions::TileOptions(TileType m_tileType) 
+	: m_tileType(m_tileType) 
 {}
\ No newline at end of file
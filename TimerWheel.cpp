@@ -0,0 +1,128 @@
+#include "TimerWheel.h"
+#include <cassert>
+#include <algorithm>
+
+TimerWheel::TimerWheel()
+	: m_iNow(0)
+	, m_iPendingCount(0)
+	, m_iFirstFree(-1)
+	, m_SlotHeads(Level0Slots + Level1Slots + Level2Slots, -1)
+{}
+
+void TimerWheel::Reset(int iNow) {
+	m_iNow = iNow;
+	m_iPendingCount = 0;
+	m_Entries.clear();
+	m_iFirstFree = -1;
+	std::fill(m_SlotHeads.begin(), m_SlotHeads.end(), -1);
+}
+
+int TimerWheel::Schedule(int iDueTick, int iPayload) {
+	int iEntry = m_iFirstFree;
+	if (iEntry >= 0) {
+		m_iFirstFree = m_Entries[iEntry].iNext;
+	} else {
+		iEntry = static_cast<int>(m_Entries.size());
+		m_Entries.emplace_back();
+	}
+
+	Entry& rEntry = m_Entries[iEntry];
+	rEntry.iDueTick = iDueTick > m_iNow ? iDueTick : m_iNow + 1;
+	rEntry.iPayload = iPayload;
+	Link(iEntry);
+	m_iPendingCount++;
+	return iEntry;
+}
+
+void TimerWheel::Cancel(int iHandle) {
+	assert(m_Entries[iHandle].iSlot >= 0);
+	Unlink(iHandle);
+	Free(iHandle);
+}
+
+void TimerWheel::SetPayload(int iHandle, int iPayload) {
+	assert(m_Entries[iHandle].iSlot >= 0);
+	m_Entries[iHandle].iPayload = iPayload;
+}
+
+void TimerWheel::Advance(int iTick, std::vector<int>& rExpiredPayloads) {
+	while (m_iNow < iTick) {
+		m_iNow++;
+
+		// Entering a new block, bring its timers down from the level above first
+		if ((m_iNow & (Level0Slots - 1)) == 0) {
+			if ((m_iNow & ((1 << Level2Shift) - 1)) == 0) {
+				Cascade(Level0Slots + Level1Slots + ((m_iNow >> Level2Shift) & (Level2Slots - 1)));
+			}
+			Cascade(Level0Slots + ((m_iNow >> Level1Shift) & (Level1Slots - 1)));
+		}
+
+		int iEntry = m_SlotHeads[m_iNow & (Level0Slots - 1)];
+		m_SlotHeads[m_iNow & (Level0Slots - 1)] = -1;
+		while (iEntry >= 0) {
+			const int iNext = m_Entries[iEntry].iNext;
+			rExpiredPayloads.push_back(m_Entries[iEntry].iPayload);
+			Free(iEntry);
+			iEntry = iNext;
+		}
+	}
+}
+
+int TimerWheel::FindSlot(int iDueTick) const {
+	if (iDueTick - m_iNow < Level0Slots) {
+		return iDueTick & (Level0Slots - 1);
+	}
+
+	// A block's slot is cascaded when time enters that block, so it has to be at most one lap away
+	const int iBlocksAhead = (iDueTick >> Level1Shift) - (m_iNow >> Level1Shift);
+	if (iBlocksAhead <= Level1Slots) {
+		return Level0Slots + ((iDueTick >> Level1Shift) & (Level1Slots - 1));
+	}
+
+	// Anything beyond the top level waits in its furthest slot and gets refiled from there
+	const int iLevel2Block = std::min((iDueTick >> Level2Shift) - (m_iNow >> Level2Shift), Level2Slots) + (m_iNow >> Level2Shift);
+	return Level0Slots + Level1Slots + (iLevel2Block & (Level2Slots - 1));
+}
+
+void TimerWheel::Link(int iEntry) {
+	Entry& rEntry = m_Entries[iEntry];
+	rEntry.iSlot = FindSlot(rEntry.iDueTick);
+	rEntry.iPrevious = -1;
+	rEntry.iNext = m_SlotHeads[rEntry.iSlot];
+	if (rEntry.iNext >= 0) {
+		m_Entries[rEntry.iNext].iPrevious = iEntry;
+	}
+	m_SlotHeads[rEntry.iSlot] = iEntry;
+}
+
+void TimerWheel::Unlink(int iEntry) {
+	const Entry& rEntry = m_Entries[iEntry];
+	if (rEntry.iPrevious >= 0) {
+		m_Entries[rEntry.iPrevious].iNext = rEntry.iNext;
+	} else {
+		m_SlotHeads[rEntry.iSlot] = rEntry.iNext;
+	}
+	if (rEntry.iNext >= 0) {
+		m_Entries[rEntry.iNext].iPrevious = rEntry.iPrevious;
+	}
+}
+
+void TimerWheel::Free(int iEntry) {
+	Entry& rEntry = m_Entries[iEntry];
+	rEntry.iSlot = -1;
+	rEntry.iNext = m_iFirstFree;
+	m_iFirstFree = iEntry;
+	m_iPendingCount--;
+}
+
+void TimerWheel::Cascade(int iSlot) {
+	// Detach the whole list first, refiling can put entries back into this same slot
+	m_CascadeScratch.clear();
+	for (int iEntry = m_SlotHeads[iSlot]; iEntry >= 0; iEntry = m_Entries[iEntry].iNext) {
+		m_CascadeScratch.push_back(iEntry);
+	}
+	m_SlotHeads[iSlot] = -1;
+	for (int iEntry : m_CascadeScratch) {
+		Link(iEntry);
+	}
+}
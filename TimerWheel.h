@@ -0,0 +1,62 @@
+#ifndef TIMERWHEEL
+#define TIMERWHEEL
+
+#include <vector>
+
+// Hierarchical timing wheel. Timers are filed by the tick they are due on, so advancing time only
+// touches timers that come due, plus an occasional cascade of far off ones into nearer slots.
+// Scheduling, cancelling and changing a payload are all constant time.
+class TimerWheel {
+public:
+	TimerWheel();
+
+	// Drops every timer and starts counting from iNow
+	void Reset(int iNow);
+	int GetNow() const { return m_iNow; }
+	int GetPendingCount() const { return m_iPendingCount; }
+
+	// Returns a handle that stays valid until the timer fires or is cancelled.
+	// Timers due now or earlier fire on the next Advance().
+	int Schedule(int iDueTick, int iPayload);
+	void Cancel(int iHandle);
+	// For when whatever the payload refers to moves, such as an index after compaction
+	void SetPayload(int iHandle, int iPayload);
+
+	// Moves time forward to iTick, appending the payload of every timer that came due
+	void Advance(int iTick, std::vector<int>& rExpiredPayloads);
+
+private:
+	// 256 single ticks, then 64 blocks of 256 ticks, then 64 blocks of 64 * 256 ticks
+	static constexpr int Level0Bits = 8;
+	static constexpr int Level1Bits = 6;
+	static constexpr int Level2Bits = 6;
+	static constexpr int Level0Slots = 1 << Level0Bits;
+	static constexpr int Level1Slots = 1 << Level1Bits;
+	static constexpr int Level2Slots = 1 << Level2Bits;
+	static constexpr int Level1Shift = Level0Bits;
+	static constexpr int Level2Shift = Level0Bits + Level1Bits;
+
+	struct Entry {
+		int iDueTick;
+		int iPayload;
+		int iSlot; // -1 while the entry is free
+		int iPrevious;
+		int iNext; // Also links the free list
+	};
+
+	int FindSlot(int iDueTick) const;
+	void Link(int iEntry);
+	void Unlink(int iEntry);
+	void Free(int iEntry);
+	// Refiles everything in a far slot, now that it is closer
+	void Cascade(int iSlot);
+
+	int m_iNow;
+	int m_iPendingCount;
+	std::vector<Entry> m_Entries;
+	int m_iFirstFree;
+	std::vector<int> m_SlotHeads; // Level 0 slots, then level 1, then level 2
+	std::vector<int> m_CascadeScratch;
+};
+
+#endif // !TIMERWHEEL
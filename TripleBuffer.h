@@ -0,0 +1,45 @@
+#ifndef TRIPLEBUFFER
+#define TRIPLEBUFFER
+
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread without locking.
+// The writer fills the back buffer and publishes it; the reader picks up whatever was
+// published last and keeps it until it asks again. Neither side ever waits for the other,
+// and buffers are reused, so containers inside T keep their capacity.
+template <typename T>
+class TripleBuffer {
+public:
+	TripleBuffer()
+		: m_iBackIndex(0)
+		, m_iMiddle(1)
+		, m_iFrontIndex(2)
+	{}
+
+	// Writer side
+	T& GetWriteBuffer() { return m_Buffers[m_iBackIndex]; }
+	void Publish() {
+		const int iOldMiddle = m_iMiddle.exchange(m_iBackIndex | NewDataBit, std::memory_order_acq_rel);
+		m_iBackIndex = iOldMiddle & IndexMask;
+	}
+
+	// Reader side. Swaps in the newest published buffer, false if nothing new arrived.
+	bool Acquire() {
+		if ((m_iMiddle.load(std::memory_order_relaxed) & NewDataBit) == 0) return false;
+		const int iOldMiddle = m_iMiddle.exchange(m_iFrontIndex, std::memory_order_acq_rel);
+		m_iFrontIndex = iOldMiddle & IndexMask;
+		return true;
+	}
+	const T& GetReadBuffer() const { return m_Buffers[m_iFrontIndex]; }
+
+private:
+	static constexpr int IndexMask = 3;
+	static constexpr int NewDataBit = 4;
+
+	T m_Buffers[3];
+	int m_iBackIndex; // Only touched by the writer
+	std::atomic<int> m_iMiddle; // Index of the spare buffer, plus NewDataBit when it holds unread data
+	int m_iFrontIndex; // Only touched by the reader
+};
+
+#endif // !TRIPLEBUFFER
@@ -0,0 +1,70 @@
+#include "WallMap.h"
+#include <cmath>
+#include <algorithm>
+
+WallMap::WallMap(float fCellSize)
+	: m_fCellSize(fCellSize)
+	, m_iWidth(0)
+	, m_iHeight(0)
+{}
+
+void WallMap::Clear() {
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_Walls.clear();
+	m_CellWalls.clear();
+}
+
+void WallMap::Build(const std::vector<sf::Vector2i>& rBlockedCells) {
+	Clear();
+
+	for (const sf::Vector2i& vCell : rBlockedCells) {
+		if (vCell.x < 0 || vCell.y < 0) continue;
+		m_iWidth = std::max(m_iWidth, vCell.x + 1);
+		m_iHeight = std::max(m_iHeight, vCell.y + 1);
+	}
+	if (m_iWidth == 0 || m_iHeight == 0) return;
+
+	// Blocked cells start out as -2, claimed ones get the index of their wall
+	const int iUnclaimed = -2;
+	m_CellWalls.assign(m_iWidth * m_iHeight, -1);
+	for (const sf::Vector2i& vCell : rBlockedCells) {
+		if (vCell.x < 0 || vCell.y < 0) continue;
+		m_CellWalls[vCell.y * m_iWidth + vCell.x] = iUnclaimed;
+	}
+
+	// Greedy merge: grow each wall as far right as it goes, then down while the whole row fits
+	for (int y = 0; y < m_iHeight; y++) {
+		for (int x = 0; x < m_iWidth; x++) {
+			if (m_CellWalls[y * m_iWidth + x] != iUnclaimed) continue;
+
+			int iWidth = 1;
+			while (x + iWidth < m_iWidth && m_CellWalls[y * m_iWidth + x + iWidth] == iUnclaimed) {
+				iWidth++;
+			}
+
+			int iHeight = 1;
+			while (y + iHeight < m_iHeight) {
+				const int* pRow = &m_CellWalls[(y + iHeight) * m_iWidth + x];
+				if (std::any_of(pRow, pRow + iWidth, [&](int iCellWall) { return iCellWall != iUnclaimed; })) break;
+				iHeight++;
+			}
+
+			const int iWall = static_cast<int>(m_Walls.size());
+			for (int iRow = y; iRow < y + iHeight; iRow++) {
+				std::fill_n(&m_CellWalls[iRow * m_iWidth + x], iWidth, iWall);
+			}
+
+			Wall& rWall = m_Walls.emplace_back();
+			rWall.vMinCell = sf::Vector2i(x, y);
+			rWall.vMaxCell = sf::Vector2i(x + iWidth - 1, y + iHeight - 1);
+			rWall.vPosition = sf::Vector2f((x + iWidth * 0.5f) * m_fCellSize, (y + iHeight * 0.5f) * m_fCellSize);
+			rWall.shape = Entity::PhysicsData();
+			rWall.shape.m_eShape = Entity::PhysicsData::Shape::Rectangle;
+			rWall.shape.m_eType = Entity::PhysicsData::Type::Static;
+			rWall.shape.m_fWidth = iWidth * m_fCellSize;
+			rWall.shape.m_fHeight = iHeight * m_fCellSize;
+			rWall.shape.setLayers(Entity::PhysicsData::Layer::Wall);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#ifndef WALLMAP
+#define WALLMAP
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "Entity.h"
+
+// Static collision geometry for the tiles enemies can't walk on, built once per layout.
+// Neighbouring blocked cells are merged into as few rectangles as possible, and every cell
+// remembers the rectangle covering it, so a query only looks at the cells it touches.
+class WallMap {
+public:
+	struct Wall {
+		sf::Vector2f vPosition; // Centre of the rectangle
+		Entity::PhysicsData shape;
+		sf::Vector2i vMinCell;
+		sf::Vector2i vMaxCell; // Inclusive
+	};
+
+	WallMap(float fCellSize);
+
+	void Build(const std::vector<sf::Vector2i>& rBlockedCells);
+	void Clear();
+
+	int GetWallCount() const { return static_cast<int>(m_Walls.size()); }
+	const Wall& GetWall(int iWall) const { return m_Walls[iWall]; }
+	int GetWallIndex(const Wall& rWall) const { return static_cast<int>(&rWall - m_Walls.data()); }
+
+	// Calls fn(wall) once for every wall touching the cells under the circle, until fn returns false.
+	// Walls near the circle but outside it are included, callers do their own exact test.
+	template <typename Fn>
+	void ForEachNear(const sf::Vector2f& vPosition, float fRadius, Fn fn) const {
+		const int iMinX = std::max(GetCell(vPosition.x - fRadius), 0);
+		const int iMaxX = std::min(GetCell(vPosition.x + fRadius), m_iWidth - 1);
+		const int iMinY = std::max(GetCell(vPosition.y - fRadius), 0);
+		const int iMaxY = std::min(GetCell(vPosition.y + fRadius), m_iHeight - 1);
+
+		for (int y = iMinY; y <= iMaxY; y++) {
+			for (int x = iMinX; x <= iMaxX; x++) {
+				const int iWall = m_CellWalls[y * m_iWidth + x];
+				if (iWall < 0) continue;
+
+				// A wall covers several cells, only report it from the first one the query reaches
+				const Wall& rWall = m_Walls[iWall];
+				if (x != std::max(rWall.vMinCell.x, iMinX) || y != std::max(rWall.vMinCell.y, iMinY)) continue;
+				if (!fn(rWall)) return;
+			}
+		}
+	}
+
+private:
+	int GetCell(float fCoordinate) const {
+		return static_cast<int>(std::floor(fCoordinate / m_fCellSize));
+	}
+
+	float m_fCellSize;
+	int m_iWidth;
+	int m_iHeight;
+	std::vector<Wall> m_Walls;
+	std::vector<int> m_CellWalls; // Wall covering each cell, -1 when it is open
+};
+
+#endif // !WALLMAP
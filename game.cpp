@@ -1,856 +1,2341 @@
-﻿#include "game.h"
-#include <SFML/Graphics.hpp>
-#include "MathHelpers.h"
-#include <random>
-#include <stdexcept>
-#include <algorithm>
-#include <cassert>
-#include "DamageTextManager.h"
-
-Game::Game()
-    : m_Window(sf::VideoMode({ 2560, 1600 }), "SFML window")
-    , m_eGameMode(Play)
-    , m_optionIndex(0)
-    , m_eScrollWheelInput(None)
-    , m_TowerTemplate(Entity::PhysicsData::Type::Static)
-    , m_enemyTemplate(Entity::PhysicsData::Type::Dynamic)
-    , m_axeTemplate(Entity::PhysicsData::Type::Dynamic)
-    , m_bDrawPath(true)
-    , m_iPlayerHealth(10)
-    , m_iPlayerGold(10)
-    , m_fTimeInPlayMode(0.0f)
-    , m_fDifficulty(1.0f)
-    , m_iGoldGainedThisUpdate(0)
-    , m_fGoldPerSecond(0.0f)
-    , m_fGoldPerSecondTimer(0.0f)
-{
-    // Load textures and check return values
-    if (!towerTexture.loadFromFile("image/player.png")) {
-        throw std::runtime_error("Failed to load player texture from 'image/player.png'");
-    }
-    if (!enemyTexture.loadFromFile("image/enemy.png")) {
-        throw std::runtime_error("Failed to load enemy texture from 'image/enemy.png'");
-    }
-    if (!axeTexture.loadFromFile("image/axe.png")) {
-        throw std::runtime_error("Failed to load axe texture from 'image/axe.png'");
-    }
-
-    // Set textures for sprites
-    m_TowerTemplate.SetTexture(towerTexture);
-    m_TowerTemplate.SetScale(sf::Vector2f(5, 5));
-    m_TowerTemplate.SetOrigin(sf::Vector2f(8, 8));
-    m_TowerTemplate.setCirclePhysics(40.f);
-    m_TowerTemplate.GetPhysicsDataNonConst().setLayers(Entity::PhysicsData::Layer::Tower);
-
-    m_enemyTemplate.SetTexture(enemyTexture);
-    m_enemyTemplate.SetScale(sf::Vector2f(5, 5));
-    m_enemyTemplate.SetPosition(sf::Vector2f(960, 540));
-    m_enemyTemplate.SetOrigin(sf::Vector2f(8, 8));
-	m_enemyTemplate.setCirclePhysics(40.f); // Set the enemy as a circle with a radius of 80 pixels
-    m_enemyTemplate.GetPhysicsDataNonConst().setLayers(Entity::PhysicsData::Layer::Enemy);
-    m_enemyTemplate.SetHealth(3);
-
-	m_axeTemplate.SetTexture(axeTexture);
-	m_axeTemplate.SetScale(sf::Vector2f(5, 5));
-	m_axeTemplate.SetOrigin(sf::Vector2f(8, 8));
-	m_axeTemplate.setCirclePhysics(40.f); // Set the axe as a circle with a radius of 80 pixels
-    m_axeTemplate.GetPhysicsDataNonConst().setLayers(Entity::PhysicsData::Layer::Projectile);
-    m_axeTemplate.GetPhysicsDataNonConst().setLayersToIgnore(Entity::PhysicsData::Layer::Projectile | Entity::PhysicsData::Layer::Tower);
-
-	m_Font.loadFromFile("Fonts/Kreon-Medium.ttf");
-
-	m_GameModeText.setPosition(sf::Vector2f(1280, 200));
-	m_GameModeText.setFont(m_Font);
-    m_GameModeText.setString("Play Mode");
-
-    m_PlayerText.setPosition(sf::Vector2f(1900, 100));
-    m_PlayerText.setString("Player");
-    m_PlayerText.setFont(m_Font);
-
-    m_GameOverText.setPosition(sf::Vector2f(1280, 800));
-    m_GameOverText.setString("GAME OVERRR");
-    m_GameOverText.setFont(m_Font);
-    m_GameOverText.setCharacterSize(100);
-
-	m_TileMapTexture.loadFromFile("image/TileMap.png");
-    for (int j = 0; j < 4; j++) {
-        for (int i = 0; i < 4; i++) {
-            sf::Sprite tileSprite;
-            tileSprite.setTexture(m_TileMapTexture);
-            tileSprite.setTextureRect(sf::IntRect(i * 16, j * 16, 16, 16)); 
-			tileSprite.setScale(sf::Vector2f(10, 10));
-			tileSprite.setOrigin(sf::Vector2f(8, 8));
-
-			TileOptions::TileType eTileType = TileOptions::TileType::Null;
-
-            if (j == 0) {
-                eTileType = TileOptions::TileType::Aesthetic;
-            } else {
-                if (j == 1) {
-                    if (i == 0){
-                        eTileType = TileOptions::TileType::Spawn;
-                    } else if (i == 1) {
-                        eTileType = TileOptions::TileType::End;
-                    } else if (i == 2) {
-                        eTileType = TileOptions::TileType::Path;
-                    }
-                }
-            }
-            
-            TileOptions& tileOption = m_TileOptions.emplace_back(eTileType);
-			tileOption.setSprite(tileSprite);
-		}
-    }
-}
-
-Game::~Game() {}
-
-void Game::run() {
-    sf::Clock clock;
-    while (m_Window.isOpen()) {
-        m_deltaTime = clock.restart();
-		HandleInput();
-        switch (m_eGameMode) {
-            case Play:
-                UpdatePlay();
-                break;
-            case LevelEditor:
-                UpdateLevelEditor();
-                break;
-        }
-        Draw();
-    }
-}
-
-void Game::UpdatePlay() {
-    m_fTimeInPlayMode += m_deltaTime.asSeconds();
-    m_fDifficulty += m_deltaTime.asSeconds() / 10.0f;
-    if (m_iPlayerHealth <= 0) return;
-
-    DamageTextManager::getInstanceNonConst().Update(m_deltaTime);
-    UpdateTower();
-    UpdateAxe();
-
-    const int iMaxEnemies = 30;
-    if (m_SpawnTiles.size() > 0 && !m_Paths.empty()) {
-        m_enemyTemplate.SetPosition(m_SpawnTiles[0].GetPosition());
-        if (m_enemies.size() < iMaxEnemies) {
-            static float fSpawnTimer = 0.0f;
-            //Speed up the Spawn Rate after 5 seconds
-            float fSpawnRate = m_fDifficulty;
-            // After 1 minutes, the spawn rate will be 2.2f
-            fSpawnTimer += m_deltaTime.asSeconds() * fSpawnRate;
-            if (fSpawnTimer > 1.0f) {
-                // Randomly spawn enemies
-                Entity& newEnemy = m_enemies.emplace_back(m_enemyTemplate);
-                newEnemy.SetPathIndex(rand() % m_Paths.size()); // Assign a random path index
-                fSpawnTimer = 0.0f;
-            }
-        }
-    }
-
-    for (int i = m_enemies.size() - 1; i >= 0; --i) {
-        Entity& rEnemy = m_enemies[i];
-		Path& path = m_Paths[rEnemy.GetPathIndex()];
-
-        //Find closest PathTile to the enemy
-		PathTile* pClosestTile = nullptr;
-        float fClosestDistance = std::numeric_limits<float>::max();
-
-        for (PathTile& tile : path) {
-			sf::Vector2f vEnemyToTile = tile.pCurrentTile -> GetPosition() - rEnemy.GetPosition();
-			float fDistance = MathHelpers::flength(vEnemyToTile);
-
-            if (fDistance < fClosestDistance) {
-              fClosestDistance = fDistance;
-              pClosestTile = &tile;
-            }
-        }
-        // Find the next path tile
-        if (!pClosestTile || !pClosestTile -> pNextTile) continue;
-        const Entity* pNextTile = pClosestTile -> pNextTile;
-
-        if (pNextTile->GetClosestGridCoordinates() == m_EndTiles[0].GetClosestGridCoordinates()) {
-            if (fClosestDistance < 40.0f) {
-                // Enemy reached the end tile, remove it
-                m_enemies.erase(m_enemies.begin() + i);
-                //m_iPlayerHealth -= 1;
-                m_fDifficulty *= 0.9f;
-                continue; // Skip to the next enemy
-            }
-        }
-
-        float fEnemySpeed = 250.0f;
-        sf::Vector2f vEnemyToNextTile = pNextTile -> GetPosition() - rEnemy.GetPosition();
-        vEnemyToNextTile = MathHelpers::normalize(vEnemyToNextTile);
-        rEnemy.SetVelocity(vEnemyToNextTile * fEnemySpeed);
-    }
-    UpdatePhysics();
-    CheckForDeletionRequest();
-
-    m_fGoldPerSecondTimer += m_deltaTime.asSeconds();
-    if (m_fGoldPerSecondTimer > 0.05f) {
-        m_fGoldPerSecond = m_fGoldPerSecond * 0.9f + 0.1f * m_iGoldGainedThisUpdate / m_fGoldPerSecondTimer;
-        m_fGoldPerSecondTimer = 0.0f;
-        m_iGoldGainedThisUpdate = 0;
-    }
-}
-
-void Game::UpdateTower() {
-    for (Entity& tower : m_Towers) {
-		//Check if it is time to throw an axe
-		tower.m_fAttackTimer -= m_deltaTime.asSeconds();
-        if (tower.m_fAttackTimer > 0.0f) continue; // Not time to throw an axe yet
-
-		//Find the closest enemy to the tower
-		Entity* pClosestEnemy = nullptr;
-        float fClosestDistance = std::numeric_limits<float>::max();
-        for (Entity& enemy : m_enemies) {
-            sf::Vector2f vTowerToEnemy = enemy.GetPosition() - tower.GetPosition();
-            float fDistance = MathHelpers::flength(vTowerToEnemy);
-            if (fDistance < fClosestDistance) {
-                fClosestDistance = fDistance;
-                pClosestEnemy = &enemy;
-            }
-        }
-
-        if (!pClosestEnemy) {
-            continue; // No enemies in range
-		}
-
-        // Rotate the tower to face the enemy
-        sf::Vector2f vTowerToEnemy = pClosestEnemy -> GetPosition() - tower.GetPosition();
-        float fAngle = MathHelpers::Angle(vTowerToEnemy);
-        tower.GetSpriteNonConst().setRotation(fAngle);
-
-        //Create an axe and set its velocity
-		Entity& newAxe = m_axes.emplace_back(m_axeTemplate);
-        newAxe.SetPosition(tower.GetPosition());
-        vTowerToEnemy = MathHelpers::normalize(vTowerToEnemy);
-        newAxe.SetVelocity(vTowerToEnemy * 500.0f);
-
-        //Reset the axe throw
-        tower.m_fAttackTimer = 1.0f;
-    }
-}
-
-void Game::UpdateAxe() {
-    for (Entity& axe : m_axes) {
-        axe.m_fAxeTimer -= m_deltaTime.asSeconds();
-        const float fAxeRotationSpeed = 360.0f;
-        axe.GetSpriteNonConst().rotate(fAxeRotationSpeed * m_deltaTime.asSeconds());
-        if (axe.m_fAxeTimer <= 0.0f) {
-            axe.RequestDeletion();
-        }
-    }
-}
-
-void Game::CheckForDeletionRequest() {
-    for (int i = m_axes.size() - 1; i >= 0; i--) {
-        Entity& axe = m_axes[i];
-        if (axe.IsDeletionRequested()) {
-            m_axes.erase(m_axes.begin() + i);
-        }
-    }
-
-    for (int i = m_enemies.size() - 1; i >= 0; i--) {
-        Entity& enemy = m_enemies[i];
-        if (enemy.IsDeletionRequested()) {
-            m_enemies.erase(m_enemies.begin() + i);
-            //m_iPlayerGold += 1;
-            AddGold(1);
-        }
-    }
-}
-
-void Game::UpdateLevelEditor() {
-	m_enemies.clear(); // Clear enemies in level editor mode
-    m_axes.clear();
-    m_Towers.clear();
-    
-    m_iPlayerGold = 10;
-    m_iPlayerHealth = 10;
-    m_iGoldGainedThisUpdate = 0;
-    m_fTimeInPlayMode = 0.0f;
-    m_fDifficulty = 1.0f;
-    m_fGoldPerSecond = 0.0f;
-    m_fGoldPerSecondTimer = 0.0f;
-}
-
-void Game::UpdatePhysics() {
-	const float fMaxDeltaTime = 0.1f; // Cap the delta time to prevent large jumps
-	const float fDeltaTime = std::min(m_deltaTime.asSeconds(), fMaxDeltaTime);
-
-    vector <Entity*> AllEntities;
-
-    for (Entity& tower : m_Towers) {
-        AllEntities.push_back(&tower);
-    }
-
-    for (Entity& enemy : m_enemies) {
-        AllEntities.push_back(&enemy);
-    }
-
-    for (Entity& axe : m_axes) {
-        AllEntities.push_back(&axe);
-    }
-
-    for (Entity* entity : AllEntities) {
-        entity -> GetPhysicsDataNonConst().ClearCollisions();
-    }
-
-    for (Entity* entity : AllEntities) {
-
-        if (entity -> GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic) {
-			entity -> move(entity -> GetPhysicsData().m_vVelocity * fDeltaTime + entity -> GetPhysicsData().m_vImpulse);
-            entity -> GetPhysicsDataNonConst().ClearImpulse();
-
-            // Check collisions
-            for (Entity* otherEntity : AllEntities) {
-				if (entity == otherEntity) continue; // Skip self-collision
-				if (entity -> shouldIgnoreEntityForPhysics(otherEntity)) continue; // Skip ignored entities
-
-                if (!entity -> GetPhysicsDataNonConst().HasCollidedThisUpdate(otherEntity) && isColiding(*entity, *otherEntity)) {
-                    entity -> OnCollision(*otherEntity);
-                    otherEntity -> OnCollision(*entity);
-
-                    entity -> GetPhysicsDataNonConst().AddEntityCollision(otherEntity);
-                    otherEntity -> GetPhysicsDataNonConst().AddEntityCollision(entity);
-                }
-				ProcessCollision(*entity, *otherEntity);
-            }
-        }
-    }
-}
-
-void Game::ProcessCollision(Entity& entity1, Entity& entity2) {   
-    assert(entity1.GetPhysicsData().m_eType != Entity::PhysicsData::Type::Static);
-    if (entity1.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Circle) {
-        // we are circle
-        if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Circle) {
-			// Both are circles
-            const sf::Vector2f vEntity1ToEntity2 = entity2.GetPosition() - entity1.GetPosition();
-			const float fDistanceBeeenEntities = MathHelpers::flength(vEntity1ToEntity2);
-            float fSumOfRadii = entity1.GetPhysicsData().m_fRadius + entity2.GetPhysicsData().m_fRadius;
-
-            if (fDistanceBeeenEntities < fSumOfRadii) {
-                const bool isEntity2Dynamic = entity2.GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic;
-                if (!isEntity2Dynamic) {    
-                    // We only need to move entity1
-                    entity1.move(-MathHelpers::normalize(vEntity1ToEntity2) * (fSumOfRadii - fDistanceBeeenEntities));
-                }
-                else {
-                    // Both entities are dynamic, we need to move both of them
-                    const sf::Vector2f vEntity1ToEntity2Normalized = MathHelpers::normalize(vEntity1ToEntity2);
-					const sf::Vector2f vEntity1Movement = vEntity1ToEntity2Normalized * (fSumOfRadii - fDistanceBeeenEntities) * 0.5f;
-					entity1.move(-vEntity1Movement);
-					entity2.move(vEntity1Movement);
-                }
-            }
-        } 
-        else if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Rectangle) {
-            // We are circle, they are rectangle
-			float fClosestX = std::clamp(entity1.GetPosition().x, entity2.GetPosition().x - entity2.GetPhysicsData().m_fWidth / 2, entity2.GetPosition().x + entity2.GetPhysicsData().m_fWidth / 2);
-			float fClosestY = std::clamp(entity1.GetPosition().y, entity2.GetPosition().y - entity2.GetPhysicsData().m_fHeight / 2, entity2.GetPosition().y + entity2.GetPhysicsData().m_fHeight / 2);
-
-			sf::Vector2f vClosestPoint(fClosestX, fClosestY);
-			sf::Vector2f vCircleToClosestPoint = vClosestPoint - entity1.GetPosition();
-			float fDistanceToClosestPoint = MathHelpers::flength(vCircleToClosestPoint);
-
-            if (fDistanceToClosestPoint < entity1.GetPhysicsData().m_fRadius) {
-                const bool isEntity2Dynamic = entity2.GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic;
-                if (!isEntity2Dynamic) {
-                    // We only need to move entity1
-                    entity1.move(-MathHelpers::normalize(vCircleToClosestPoint) * (entity1.GetPhysicsData().m_fRadius - fDistanceToClosestPoint));
-                }
-                else {
-					const sf::Vector2f vEntity1ToEntity2Normalized = MathHelpers::normalize(vCircleToClosestPoint);
-					const sf::Vector2f vEntity1Movement = vEntity1ToEntity2Normalized * (entity1.GetPhysicsData().m_fRadius - fDistanceToClosestPoint) * 0.5f;
-                    entity1.move(-vEntity1Movement);
-                    entity2.move(vEntity1Movement); 
-                }
-            }
-        }
-    } 
-    else if (entity1.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Rectangle){
-		// we are rectangle
-        if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Rectangle) {
-            // Both are rectangles
-            float fDistanceX = std::abs(entity1.GetPosition().x - entity2.GetPosition().x);
-            float fDistanceY = std::abs(entity1.GetPosition().y - entity2.GetPosition().y);
-
-            float fOverlapX = (entity1.GetPhysicsData().m_fWidth + entity2.GetPhysicsData().m_fWidth) / 2 - fDistanceX;
-            float fOverlapY = (entity1.GetPhysicsData().m_fHeight + entity2.GetPhysicsData().m_fHeight) / 2 - fDistanceY;
-            if (fOverlapX > 0 && fOverlapY > 0) {
-				const bool isEntity2Dynamic = entity2.GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic;
-                // Guarantee a collision
-                if (fOverlapX < fOverlapY) {
-                    if (entity1.GetPosition().x < entity2.GetPosition().x) {
-                        if (isEntity2Dynamic) {
-                            entity1.move(sf::Vector2f(-fOverlapX / 2, 0));
-                            entity2.move(sf::Vector2f(fOverlapX / 2, 0));
-                        } else {
-                            entity1.move(sf::Vector2f(-fOverlapX, 0));
-						}
-                    } else {
-                        if (isEntity2Dynamic) {
-                            entity1.move(sf::Vector2f(fOverlapX / 2, 0));
-                            entity2.move(sf::Vector2f(-fOverlapX / 2, 0));
-                        }
-                        else {
-                            entity1.move(sf::Vector2f(fOverlapX, 0));
-                        }
-                    }
-                }
-                else {
-                    if (entity1.GetPosition().y < entity2.GetPosition().y) {
-                        if (isEntity2Dynamic) {
-                            entity1.move(sf::Vector2f(0, -fOverlapY / 2));
-                            entity2.move(sf::Vector2f(0, fOverlapY / 2));
-                        }
-                        else {
-                            entity1.move(sf::Vector2f(0, -fOverlapY));
-                        }
-                    } else {
-                        if (isEntity2Dynamic) {
-                            entity1.move(sf::Vector2f(0, fOverlapY / 2));
-                            entity2.move(sf::Vector2f(0, -fOverlapY / 2));
-                        }
-                        else {
-                            entity1.move(sf::Vector2f(0, fOverlapY));
-						}
-                    }
-                }
-            }
-        } else if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Circle) {
-            // We are rectangle, they are circle
-			float fClosestX = std::clamp(entity2.GetPosition().x, entity1.GetPosition().x - entity1.GetPhysicsData().m_fWidth / 2, entity1.GetPosition().x + entity1.GetPhysicsData().m_fWidth / 2);
-			float fClosestY = std::clamp(entity2.GetPosition().y, entity1.GetPosition().y - entity1.GetPhysicsData().m_fHeight / 2, entity1.GetPosition().y + entity1.GetPhysicsData().m_fHeight / 2);
-
-			sf::Vector2f vClosestPoint(fClosestX, fClosestY);
-			sf::Vector2f vCircleToClosestPoint = vClosestPoint - entity2.GetPosition();
-            float fDistanceToClosestPoint = MathHelpers::flength(vCircleToClosestPoint);
-
-            if (fDistanceToClosestPoint < entity2.GetPhysicsData().m_fRadius) {
-                const bool isEntity2Dynamic = entity2.GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic;
-                if (!isEntity2Dynamic) {
-                    // We only need to move entity1
-                    entity1.move(MathHelpers::normalize(vCircleToClosestPoint) * (entity2.GetPhysicsData().m_fRadius - fDistanceToClosestPoint));
-                }
-                else {
-					const sf::Vector2f vEntity2ToEntity1Normalized = MathHelpers::normalize(vCircleToClosestPoint);
-                    const sf::Vector2f vEntity2Movement = vEntity2ToEntity1Normalized * (entity2.GetPhysicsData().m_fRadius - fDistanceToClosestPoint) * 0.5f;
-                    entity1.move(vEntity2Movement);
-                    entity2.move(-vEntity2Movement);
-                }
-            }
-        }
-    }
-}
-
-bool Game::isColiding(const Entity& entity1, const Entity& entity2) {
-    if (entity1.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Circle) {
-        // we are circle
-        if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Circle) {
-            // Both are circles
-            const sf::Vector2f vEntity1ToEntity2 = entity2.GetPosition() - entity1.GetPosition();
-            const float fDistanceBeeenEntities = MathHelpers::flength(vEntity1ToEntity2);
-            float fSumOfRadii = entity1.GetPhysicsData().m_fRadius + entity2.GetPhysicsData().m_fRadius;
-
-            if (fDistanceBeeenEntities < fSumOfRadii) {
-                return true;
-            }
-        }
-        else if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Rectangle) {
-            // We are circle, they are rectangle
-            float fClosestX = std::clamp(entity1.GetPosition().x, entity2.GetPosition().x - entity2.GetPhysicsData().m_fWidth / 2, entity2.GetPosition().x + entity2.GetPhysicsData().m_fWidth / 2);
-            float fClosestY = std::clamp(entity1.GetPosition().y, entity2.GetPosition().y - entity2.GetPhysicsData().m_fHeight / 2, entity2.GetPosition().y + entity2.GetPhysicsData().m_fHeight / 2);
-
-            sf::Vector2f vClosestPoint(fClosestX, fClosestY);
-            sf::Vector2f vCircleToClosestPoint = vClosestPoint - entity1.GetPosition();
-            float fDistanceToClosestPoint = MathHelpers::flength(vCircleToClosestPoint);
-
-            if (fDistanceToClosestPoint < entity1.GetPhysicsData().m_fRadius) {
-                return true;
-            }
-        }
-    }
-    else if (entity1.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Rectangle) {
-        // we are rectangle
-        if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Rectangle) {
-            // Both are rectangles
-            float fDistanceX = std::abs(entity1.GetPosition().x - entity2.GetPosition().x);
-            float fDistanceY = std::abs(entity1.GetPosition().y - entity2.GetPosition().y);
-
-            float fOverlapX = (entity1.GetPhysicsData().m_fWidth + entity2.GetPhysicsData().m_fWidth) / 2 - fDistanceX;
-            float fOverlapY = (entity1.GetPhysicsData().m_fHeight + entity2.GetPhysicsData().m_fHeight) / 2 - fDistanceY;
-            if (fOverlapX > 0 && fOverlapY > 0) {
-                return true;
-            }
-        }
-        else if (entity2.GetPhysicsData().m_eShape == Entity::PhysicsData::Shape::Circle) {
-            // We are rectangle, they are circle
-            float fClosestX = std::clamp(entity2.GetPosition().x, entity1.GetPosition().x - entity1.GetPhysicsData().m_fWidth / 2, entity1.GetPosition().x + entity1.GetPhysicsData().m_fWidth / 2);
-            float fClosestY = std::clamp(entity2.GetPosition().y, entity1.GetPosition().y - entity1.GetPhysicsData().m_fHeight / 2, entity1.GetPosition().y + entity1.GetPhysicsData().m_fHeight / 2);
-
-            sf::Vector2f vClosestPoint(fClosestX, fClosestY);
-            sf::Vector2f vCircleToClosestPoint = vClosestPoint - entity2.GetPosition();
-            float fDistanceToClosestPoint = MathHelpers::flength(vCircleToClosestPoint);
-
-            if (fDistanceToClosestPoint < entity2.GetPhysicsData().m_fRadius) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-void Game::DrawPlay() {
-    sf::Vector2f vMousePosition = (sf::Vector2f)sf::Mouse::getPosition(m_Window);
-    m_TowerTemplate.SetPosition(vMousePosition);
-
-    if (CanPlaceTowerAtPosition(vMousePosition)) {
-        m_TowerTemplate.SetColor(sf::Color::Green);
-    }
-    else {
-        m_TowerTemplate.SetColor(sf::Color::Red);
-    }
-
-    for (const Entity& tower : m_Towers) {
-        m_Window.draw(tower);
-    }
-
-    for (const Entity& enemy : m_enemies) {
-        m_Window.draw(enemy);
-    }
-
-    for (const Entity& axe : m_axes) {
-        m_Window.draw(axe);
-    }
-
-    DamageTextManager::getInstanceConst().Draw(m_Window);
-
-
-    m_Window.draw(m_TowerTemplate); // Draw the tower template
-
-    if (m_iPlayerHealth <= 0) {
-        //draw the game over text
-        m_Window.draw(m_GameOverText);
-    }
-
-    m_PlayerText.setString("Difficulty: " + to_string(m_fDifficulty) + 
-        "\nPlayer's Gold: " + to_string(m_iPlayerGold) + 
-        "\nGold Per Second: " + to_string(m_fGoldPerSecond));
-    m_Window.draw(m_PlayerText);
-}
-
-void Game::Draw() {
-	// Erase the previous frame
-    m_Window.clear();
-
-    for (const Entity& entity : m_AestheticTiles) {
-        m_Window.draw(entity);
-    }
-	//Draw the game mode text 
-	m_Window.draw(m_GameModeText);
-
-    switch (m_eGameMode) {
-        case Play:
-            DrawPlay();
-            break;
-        case LevelEditor:
-            DrawLevelEditor();
-            break;
-    }
-    m_Window.display();
-}
-
-void Game::HandleInput() {
-	static bool bTwasPressedLastUpdate = false;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::T)) {
-        if (!bTwasPressedLastUpdate) {
-            if (m_eGameMode == Play) {
-                m_eGameMode = LevelEditor;
-				m_GameModeText.setString("Level Editor Mode");
-            } else {
-                m_eGameMode = Play;
-				m_GameModeText.setString("Play Mode");
-			}
-        }
-		bTwasPressedLastUpdate = true;
-    }
-    else {
-		bTwasPressedLastUpdate = false;
-    }
-
-    sf::Event event;
-    m_eScrollWheelInput = None;
-    while (m_Window.pollEvent(event)) {
-        switch (event.type) {
-        case sf::Event::Closed:
-            m_Window.close();
-            break;
-        case sf::Event::MouseWheelScrolled:
-            if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
-                if (event.mouseWheelScroll.delta > 0) {
-                    m_eScrollWheelInput = ScrollUp;
-                }
-                else {
-                    m_eScrollWheelInput = ScrollDown;
-                }
-            }
-            break;
-        }
-    }
-
-    switch (m_eGameMode) {
-        case Play:
-            HandlePlayInput();
-            break;
-        case LevelEditor:
-            HandleLevelEditorInput();
-            break;
-    }
-}
-
-void Game::CreateTileAtPosition(const sf::Vector2f& pos) {
-    int x = pos.x / 160;
-    int y = pos.y / 160;
-
-    TileOptions::TileType eTileType = m_TileOptions[m_optionIndex].getTileType();
-    if (eTileType == TileOptions::TileType::Null) return;
-
-    vector<Entity>& ListOfTiles = GetListOfTiles(eTileType);
-
-    if (eTileType == TileOptions::TileType::Spawn || eTileType == TileOptions::TileType::End) {
-		ListOfTiles.clear(); // Clear existing spawn or end tiles (if more than 1)
-    }
-
-	sf::Sprite tile = m_TileOptions[m_optionIndex].getSprite();
-	tile.setPosition(x * 160 + 80, y * 160 + 80);
-
-    for (int i = 0; i < ListOfTiles.size(); i++) {
-        if (ListOfTiles[i].GetPosition() == tile.getPosition()) {
-            ListOfTiles[i] = ListOfTiles.back(); // Move the last tile to the current position
-            ListOfTiles.pop_back(); // Remove the last tile
-			break; // Tile already exists at this position, do not add a duplicate
-        }
-    }
-
-	Entity& new_tiles = ListOfTiles.emplace_back(Entity::PhysicsData::Type::Static);
-	new_tiles.SetSprite(tile);
-	new_tiles.setRectanglePhysics(160.0f, 160.0f);
-    ConstructionPath();
-}
-
-void Game::DeleteTileAtPosition(const sf::Vector2f& pos) {
-    int x = pos.x / 160;
-    int y = pos.y / 160;
-
-	// Calculate the tile position based on the grid size (160x160)
-    sf::Vector2f tilePosition(x * 160 + 80, y * 160 + 80);
-
-    TileOptions::TileType eTileType = m_TileOptions[m_optionIndex].getTileType();
-    if (eTileType == TileOptions::TileType::Null) return;
-    vector<Entity>& ListOfTiles = GetListOfTiles(eTileType);
-
-    for (int i = 0; i < ListOfTiles.size(); i++) {
-        if (ListOfTiles[i].GetPosition() == tilePosition) {
-            ListOfTiles[i] = ListOfTiles.back(); // Move the last tile to the current position
-            ListOfTiles.pop_back(); // Remove the last tile
-            break; // Tile found and removed
-        }
-	}
-}
-
-void Game::ConstructionPath() {
-    m_Paths.clear();
-    if (m_SpawnTiles.empty() || m_EndTiles.empty()) {
-        return;
-    }
-
-    Path newPath;
-    PathTile& start = newPath.emplace_back();
-    start.pCurrentTile = &m_SpawnTiles[0];
-
-    sf::Vector2i vEndCoords = m_EndTiles[0].GetClosestGridCoordinates();
-    VisitPathNeighbors(newPath, vEndCoords);
-}
-
-void Game::VisitPathNeighbors(Path path, const sf::Vector2i& rEndCoords) {
-    const sf::Vector2i vCurrentTilePosition = path.back().pCurrentTile -> GetClosestGridCoordinates();
-    
-    const sf::Vector2i vNorthCoords(vCurrentTilePosition.x, vCurrentTilePosition.y - 1);
-    const sf::Vector2i vEastCoords(vCurrentTilePosition.x + 1, vCurrentTilePosition.y);
-    const sf::Vector2i vSouthCoords(vCurrentTilePosition.x, vCurrentTilePosition.y + 1);
-    const sf::Vector2i vWestCoords(vCurrentTilePosition.x - 1, vCurrentTilePosition.y);
-
-    if (rEndCoords == vNorthCoords || rEndCoords == vEastCoords || rEndCoords == vSouthCoords || rEndCoords == vWestCoords) {
-        // Set the last tile in our current path to point to the next tile
-        path.back().pNextTile = &m_EndTiles[0];
-        // Add the next tile, and set it.
-        PathTile& newTile = path.emplace_back();
-        newTile.pCurrentTile = &m_EndTiles[0];
-        m_Paths.push_back(path);
-
-        // If any of our paths are next to the end tile, they should probably go straight to end and terminate.
-        // If we didn't return here, we could move around the end tile before going into it.
-        return;
-    }
-
-    const vector<Entity>& pathTiles = GetListOfTiles(TileOptions::TileType::Path);
-
-    for (const Entity& pathTile : pathTiles) {
-        const sf::Vector2i vPathTileCoords = pathTile.GetClosestGridCoordinates();
-
-        if (DoesPathContainCoordinates(path, vPathTileCoords)) {
-            continue; // Skip if the path already contains this tile
-		}
-
-        if (vPathTileCoords == vNorthCoords || vPathTileCoords == vEastCoords || vPathTileCoords == vSouthCoords || vPathTileCoords == vWestCoords) {
-			// We have a neighbor tile
-            Path newPath = path; // Create a copy of the current path
-			newPath.back().pNextTile = &pathTile; // Set the next tile in the path
-            PathTile& newTile = newPath.emplace_back();
-			newTile.pCurrentTile = &pathTile;
-
-            if (vPathTileCoords == rEndCoords) {
-                // We reached the end tile
-                m_Paths.push_back(newPath);
-            } else {
-                // Continue visiting neighbors
-                VisitPathNeighbors(newPath, rEndCoords);
-			}
-		}
-    }
-}
-
-bool Game::DoesPathContainCoordinates(const Path& path, const sf::Vector2i& coords) {
-    for (const PathTile& tile : path) {
-        if (tile.pCurrentTile -> GetClosestGridCoordinates() == coords) {
-            return true; // Found a tile with the same coordinates
-        }
-    }
-    return false; // No tile with the same coordinates found
-}
-
-void Game::DrawLevelEditor() {
-	sf::Vector2f vMousePosition = (sf::Vector2f)sf::Mouse::getPosition(m_Window);
-	m_TileOptions[m_optionIndex].setPosition(vMousePosition);
-
-	TileOptions::TileType eTileType = m_TileOptions[m_optionIndex].getTileType();
-
-    if (m_bDrawPath) {
-        for (const Entity& entity : m_SpawnTiles) {
-            m_Window.draw(entity);
-        }
-
-        for (const Entity& entity : m_EndTiles) {
-            m_Window.draw(entity);
-        }
-
-        for (const Entity& entity : m_PathTiles) {
-            m_Window.draw(entity);
-        }
-    }
-	m_Window.draw(m_TileOptions[m_optionIndex]);
-}
-
-void Game::HandlePlayInput() {
-    if (sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
-		sf::Vector2f vMousePosition = (sf::Vector2f)sf::Mouse::getPosition(m_Window);
-        if (m_iPlayerGold >= 3) {
-            if (CreateTowerAtPosition(vMousePosition)) {
-                m_iPlayerGold -= 3;
-            }
-        }
-    }
-}
-
-void Game::HandleLevelEditorInput() {
-
-    if (m_eScrollWheelInput == ScrollUp) {
-        m_optionIndex++;
-        if (m_optionIndex >= m_TileOptions.size()) {
-            m_optionIndex = 0;
-        }
-    }
-    else if (m_eScrollWheelInput == ScrollDown) {
-        m_optionIndex--;
-        if (m_optionIndex < 0) {
-            m_optionIndex = m_TileOptions.size() - 1;
-        }
-    }
-
-    if (sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
-        sf::Vector2f vMousePosition = (sf::Vector2f)sf::Mouse::getPosition(m_Window);
-        CreateTileAtPosition(vMousePosition);
-    }
-
-    if (sf::Mouse::isButtonPressed(sf::Mouse::Right)) {
-        sf::Vector2f vMousePosition = (sf::Vector2f)sf::Mouse::getPosition(m_Window);
-        DeleteTileAtPosition(vMousePosition);
-    }
-}
-
-vector<Entity>& Game::GetListOfTiles(TileOptions::TileType eTileType) {
-    switch (eTileType) {
-        case TileOptions::TileType::Aesthetic:
-            return m_AestheticTiles;
-        case TileOptions::TileType::Spawn:
-            return m_SpawnTiles;
-        case TileOptions::TileType::End:
-            return m_EndTiles;
-        case TileOptions::TileType::Path:
-            return m_PathTiles;
-	}
-	return m_AestheticTiles; // Default return if no match found
-}
-
-bool Game::CreateTowerAtPosition(const sf::Vector2f& pos) {
-    if (CanPlaceTowerAtPosition(pos)) {
-        Entity newTower = m_TowerTemplate;
-        newTower.SetColor(sf::Color::White);
-        m_Towers.push_back(newTower);
-        return true;
-    }
-    return false;
-}
-
-bool Game::CanPlaceTowerAtPosition(const sf::Vector2f& pos) {
-    sf::IntRect brickRect(0, 0, 16, 16);
-	vector<Entity>& ListOfTiles = GetListOfTiles(TileOptions::TileType::Aesthetic);
-	bool isOnBrick = false;
-    Entity copyOfTowerWithRadiusOf1 = m_TowerTemplate;
-    copyOfTowerWithRadiusOf1.setCirclePhysics(1.0f);
-
-    for (const Entity& tile : ListOfTiles) {
-		const sf::Sprite& rTileSprite = tile.GetSprite();
-		sf::IntRect tileRect = rTileSprite.getTextureRect();
-
-        if (tileRect != brickRect) {
-            continue;
-        }
-
-        if (isColiding(tile, copyOfTowerWithRadiusOf1)) {
-            isOnBrick = true;
-            break;
-		}
-    }
-
-    if (!isOnBrick) {
-        return false;
-	}
-
-    for (const Entity& tower : m_Towers) {
-        if (isColiding(tower, m_TowerTemplate)) {
-            return false;
-		}
-	}
-    return true;
-}
-
-void Game::AddGold(int gold) {
-    m_iPlayerGold += gold;
-    m_iGoldGainedThisUpdate += gold;
+﻿#include "game.h"
+#include <SFML/Graphics.hpp>
+#include "MathHelpers.h"
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+#include <cstring>
+#include <set>
+#include <functional>
+#include "DamageTextManager.h"
+#include "Narrowphase.h"
+#include "AllocationTracker.h"
+
+namespace {
+    // Indexed by Entity::TargetingMode
+    const char* const TargetingModeNames[] = { "First", "Last", "Strongest", "Closest" };
+
+    // Splash towers cost more and fire the same rate, their axes hit everything near the impact
+    const int TowerCost = 3;
+    const int SplashTowerCost = 6;
+    const float SplashRadius = 200.0f;
+    const sf::Color SplashColor(255, 160, 64);
+
+    // Tower reloads and axe lifetimes are counted in whole timer ticks
+    const float TimerTickSeconds = 1.0f / 120.0f;
+    const int TowerReloadTicks = 120;
+    const int AxeLifetimeTicks = 360;
+
+    const float AxeSpeed = 500.0f;
+    const float AxeSpinDegreesPerSecond = 360.0f;
+}
+
+Game::Game(bool bHeadless, unsigned int uSeed)
+    : m_eGameMode(Play)
+    , m_optionIndex(0)
+    , m_eScrollWheelInput(None)
+    , m_TowerPrototype(Entity::PhysicsData::Type::Static)
+    , m_TowerTemplate(m_TowerPrototype)
+    , m_EnemyPrototype(Entity::PhysicsData::Type::Dynamic)
+    , m_EnemyGrid(80.0f)
+    , m_fLargestEnemyRadius(0.0f)
+    , m_AxePrototype(Entity::PhysicsData::Type::Sensor)
+    , m_fTimerRemainder(0.0f)
+    , m_pPhysicsTrace(nullptr)
+    , m_iPhysicsDivergences(0)
+    , m_RouteMap(160.0f)
+    , m_PlacementMap(160.0f)
+    , m_WallMap(160.0f)
+    , m_bWallsOutOfDate(false)
+    , m_bDrawPath(true)
+    , m_iPlayerHealth(10)
+    , m_iPlayerGold(10)
+    , m_fTimeInPlayMode(0.0f)
+    , m_fDifficulty(1.0f)
+    , m_iGoldGainedThisUpdate(0)
+    , m_fGoldPerSecond(0.0f)
+    , m_fGoldPerSecondTimer(0.0f)
+    , m_fSpawnTimer(0.0f)
+    , m_bHeadless(bHeadless)
+    , m_iEnemiesSpawned(0)
+    , m_iAxesThrown(0)
+    , m_iEnemiesKilled(0)
+    , m_iEnemiesLeaked(0)
+    , m_iGoldEarned(0)
+    , m_bTwasPressedLastUpdate(false)
+    , m_eDrawnGameMode(Play)
+    , m_fFrameRate(60.0f)
+    , m_LastPolledMouse()
+    , m_uSceneRevision(0)
+    , m_bInputSeen(false)
+    , m_bLeftMouseDown(false)
+    , m_bRightMouseDown(false)
+    , m_bRightMouseDownLastUpdate(false)
+    , m_bPlaceSplashTower(false)
+    , m_bSimulationRunning(false)
+    , m_Rng(uSeed)
+    , m_FrameArena(1024 * 1024)
+{
+    if (!m_bHeadless) {
+        m_Window.create(sf::VideoMode({ 2560, 1600 }), "SFML window");
+        m_ScreenBounds = sf::FloatRect(0.0f, 0.0f, 2560.0f, 1600.0f);
+
+        // Load textures and check return values
+        if (!towerTexture.loadFromFile("image/player.png")) {
+            throw std::runtime_error("Failed to load player texture from 'image/player.png'");
+        }
+        if (!enemyTexture.loadFromFile("image/enemy.png")) {
+            throw std::runtime_error("Failed to load enemy texture from 'image/enemy.png'");
+        }
+        if (!axeTexture.loadFromFile("image/axe.png")) {
+            throw std::runtime_error("Failed to load axe texture from 'image/axe.png'");
+        }
+        m_Font.loadFromFile("Fonts/Kreon-Medium.ttf");
+        m_DamageTextManager.LoadFont("Fonts/Kreon-Medium.ttf");
+        m_TileMapTexture.loadFromFile("image/TileMap.png");
+    }
+
+    // Set textures for sprites
+    m_TowerPrototype.m_Sprite.setTexture(towerTexture);
+    m_TowerPrototype.m_Sprite.setScale(sf::Vector2f(5, 5));
+    m_TowerPrototype.m_Sprite.setOrigin(sf::Vector2f(8, 8));
+    m_TowerPrototype.setCirclePhysics(40.f);
+    m_TowerPrototype.m_PhysicsData.setLayers(Entity::PhysicsData::Layer::Tower);
+
+    m_EnemyPrototype.m_Sprite.setTexture(enemyTexture);
+    m_EnemyPrototype.m_Sprite.setScale(sf::Vector2f(5, 5));
+    m_EnemyPrototype.m_Sprite.setOrigin(sf::Vector2f(8, 8));
+	m_EnemyPrototype.setCirclePhysics(40.f); // Set the enemy as a circle with a radius of 80 pixels
+    m_EnemyPrototype.m_PhysicsData.setLayers(Entity::PhysicsData::Layer::Enemy);
+    m_EnemyPrototype.m_iHealth = 3;
+
+	m_AxePrototype.m_Sprite.setTexture(axeTexture);
+	m_AxePrototype.m_Sprite.setScale(sf::Vector2f(5, 5));
+	m_AxePrototype.m_Sprite.setOrigin(sf::Vector2f(8, 8));
+	m_AxePrototype.setCirclePhysics(40.f); // Set the axe as a circle with a radius of 80 pixels
+    m_AxePrototype.m_PhysicsData.setLayers(Entity::PhysicsData::Layer::Projectile);
+
+	m_GameModeText.setPosition(sf::Vector2f(1280, 200));
+	m_GameModeText.setFont(m_Font);
+    m_GameModeText.setString("Play Mode");
+
+    m_PlayerText.setPosition(sf::Vector2f(1900, 100));
+    m_PlayerText.setString("Player");
+    m_PlayerText.setFont(m_Font);
+
+    m_GameOverText.setPosition(sf::Vector2f(1280, 800));
+    m_GameOverText.setString("GAME OVERRR");
+    m_GameOverText.setFont(m_Font);
+    m_GameOverText.setCharacterSize(100);
+
+    // Tiles point at their prototype, so the list must not reallocate once tiles exist
+    m_TilePrototypes.reserve(16);
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            sf::Sprite tileSprite;
+            tileSprite.setTexture(m_TileMapTexture);
+            tileSprite.setTextureRect(sf::IntRect(i * 16, j * 16, 16, 16)); 
+			tileSprite.setScale(sf::Vector2f(10, 10));
+			tileSprite.setOrigin(sf::Vector2f(8, 8));
+
+			TileOptions::TileType eTileType = TileOptions::TileType::Null;
+
+            if (j == 0) {
+                eTileType = TileOptions::TileType::Aesthetic;
+            } else {
+                if (j == 1) {
+                    if (i == 0){
+                        eTileType = TileOptions::TileType::Spawn;
+                    } else if (i == 1) {
+                        eTileType = TileOptions::TileType::End;
+                    } else if (i == 2) {
+                        eTileType = TileOptions::TileType::Path;
+                    }
+                }
+            }
+            
+            TileOptions& tileOption = m_TileOptions.emplace_back(eTileType);
+			tileOption.setSprite(tileSprite);
+
+            Entity::Prototype& tilePrototype = m_TilePrototypes.emplace_back(Entity::PhysicsData::Type::Static);
+            tilePrototype.m_Sprite = tileSprite;
+            tilePrototype.setRectanglePhysics(160.0f, 160.0f);
+		}
+    }
+}
+
+Game::~Game() {}
+
+Game::Metrics::Metrics()
+    : rTicks(registry.AddCounter("td_ticks_total", "Play ticks simulated"))
+    , rLiveEnemies(registry.AddGauge("td_live_enemies", "Enemies alive after the last tick"))
+    , rLiveAxes(registry.AddGauge("td_live_axes", "Axes in flight after the last tick"))
+    , rTowers(registry.AddGauge("td_towers", "Towers placed"))
+    , rRoutedSpawns(registry.AddGauge("td_routed_spawns", "Spawns with a route to an exit"))
+    , rExits(registry.AddGauge("td_exits", "Exits in the level"))
+    , rPairsTested(registry.AddCounter("td_broadphase_pairs_tested_total", "Pairs passed to the narrowphase"))
+    , rCollisionsResolved(registry.AddCounter("td_collisions_resolved_total", "Overlapping pairs pushed apart"))
+    , rFrameArenaBytes(registry.AddGauge("td_frame_arena_bytes", "Scratch bytes the last tick took from the frame arena"))
+    , rFrameArenaOverflows(registry.AddGauge("td_frame_arena_overflows", "Ticks that outgrew the frame arena and used the heap"))
+    , rStorageGrowths(registry.AddCounter("td_entity_storage_growths_total", "Times enemy or axe storage had to reallocate"))
+    , rGoldPerSecond(registry.AddGauge("td_gold_per_second", "Smoothed gold income"))
+    , rTickSeconds(registry.AddHistogram("td_tick_seconds", "Time spent in one play tick",
+        { 0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.033, 0.066, 0.1 }))
+    , rLodDeferred(registry.AddCounter("td_lod_deferred_updates_total", "Low priority updates put off to a later tick"))
+    , rFramesPresented(registry.AddCounter("td_frames_presented_total", "Frames drawn and shown in the window"))
+    , rFramesSkipped(registry.AddCounter("td_frames_skipped_total", "Frames not drawn because nothing on screen changed"))
+    , rFrameJitter(registry.AddGauge("td_frame_jitter_seconds", "Standard deviation of the frame time over the last second"))
+{}
+
+void Game::run() {
+    m_bSimulationRunning = true;
+    std::thread simulationThread(&Game::RunSimulation, this);
+
+    FramePacer pacer(m_fFrameRate);
+    bool bDrawnAny = false;
+    unsigned int uDrawnRevision = 0;
+
+    // The window only lets the thread that created it poll events, so input and drawing stay here
+    while (m_Window.isOpen()) {
+        const bool bInput = PollWindowInput();
+        m_Snapshots.Acquire();
+        const RenderSnapshot& rSnapshot = m_Snapshots.GetReadBuffer();
+
+        // The editor and the game over screen sit still without input, so the last frame shown is still right
+        const bool bStillScene = rSnapshot.bLevelEditor || rSnapshot.bGameOver;
+        if (!bStillScene || bInput || !bDrawnAny || rSnapshot.uSceneRevision != uDrawnRevision) {
+            Draw(rSnapshot);
+            bDrawnAny = true;
+            uDrawnRevision = rSnapshot.uSceneRevision;
+            m_Metrics.rFramesPresented.Add(1);
+        } else {
+            m_Metrics.rFramesSkipped.Add(1);
+        }
+
+        pacer.WaitForNextFrame();
+        FramePacer::Stats recentStats;
+        if (pacer.TakeRecentStats(recentStats)) {
+            m_Metrics.rFrameJitter.Set(recentStats.fJitterSeconds);
+        }
+    }
+
+    m_bSimulationRunning = false;
+    m_InputSeen.notify_one();
+    simulationThread.join();
+
+    const FramePacer::Stats stats = pacer.GetOverallStats();
+    cout << "Frame pacing over " << stats.iFrames << " frames at " << m_fFrameRate << " fps: mean ms " << stats.fMeanSeconds * 1000.0
+        << ", jitter ms " << stats.fJitterSeconds * 1000.0 << ", worst ms " << stats.fWorstSeconds * 1000.0 << "\n";
+    if (AllocationTracker::IsEnabled()) {
+        AllocationTracker::WriteScopeReport(cout);
+    }
+}
+
+void Game::RunSimulation() {
+    // Ticks faster than this just take the core away from the render thread
+    const sf::Time minTickTime = sf::seconds(1.0f / 240.0f);
+    // Still scenes only change on input, the timeout just keeps an eye on shutdown
+    const sf::Time idleTimeout = sf::milliseconds(100);
+
+    bool bPublishedAny = false;
+    unsigned int uPublishedRevision = 0;
+    sf::Clock clock;
+    while (m_bSimulationRunning) {
+        m_deltaTime = clock.restart();
+        m_FrameArena.Reset();
+		const bool bInputChanged = HandleInput();
+        const bool bMatchWasRunning = m_eGameMode == Play && m_iPlayerHealth > 0;
+        switch (m_eGameMode) {
+            case Play:
+                UpdatePlay();
+                break;
+            case LevelEditor:
+                UpdateLevelEditor();
+                break;
+        }
+        // Only input changes the editor or a lost match, a running match changes every tick,
+        // including the one it was lost on
+        const bool bStillScene = m_eGameMode == LevelEditor || m_iPlayerHealth <= 0;
+        if (bInputChanged || !bStillScene || bMatchWasRunning) {
+            m_uSceneRevision++;
+        }
+
+        // The last snapshot already shows an unchanged scene, copying every tile again would only waste the tick
+        if (!bPublishedAny || m_uSceneRevision != uPublishedRevision) {
+            WriteSnapshot(m_Snapshots.GetWriteBuffer());
+            m_Snapshots.Publish();
+            bPublishedAny = true;
+            uPublishedRevision = m_uSceneRevision;
+        }
+
+        if (bStillScene) {
+            WaitForInput(idleTimeout);
+            continue;
+        }
+        const sf::Time tickTime = clock.getElapsedTime();
+        if (tickTime < minTickTime) {
+            sf::sleep(minTickTime - tickTime);
+        }
+    }
+}
+
+void Game::WaitForInput(const sf::Time& timeout) {
+    std::unique_lock<std::mutex> lock(m_InputMutex);
+    m_InputSeen.wait_for(lock, std::chrono::microseconds(timeout.asMicroseconds()), [this] { return m_bInputSeen || !m_bSimulationRunning; });
+    m_bInputSeen = false;
+}
+
+void Game::WriteSnapshot(RenderSnapshot& rSnapshot) {
+    AllocationTracker::Scope allocationScope("render snapshot");
+    // Clearing keeps the capacity, so a snapshot only allocates while the game is growing
+    rSnapshot.Tiles.clear();
+    for (const Entity& tile : m_AestheticTiles) {
+        rSnapshot.Tiles.push_back(RenderSnapshot::MakeItem(tile));
+    }
+
+    rSnapshot.RouteTiles.clear();
+    if (m_bDrawPath) {
+        for (const Entity& tile : m_SpawnTiles) {
+            rSnapshot.RouteTiles.push_back(RenderSnapshot::MakeItem(tile));
+        }
+        for (const Entity& tile : m_EndTiles) {
+            rSnapshot.RouteTiles.push_back(RenderSnapshot::MakeItem(tile));
+        }
+        for (const Entity& tile : m_PathTiles) {
+            rSnapshot.RouteTiles.push_back(RenderSnapshot::MakeItem(tile));
+        }
+    }
+
+    rSnapshot.Entities.clear();
+    for (const Entity& tower : m_Towers) {
+        rSnapshot.Entities.push_back(RenderSnapshot::MakeItem(tower));
+    }
+    for (const Entity& enemy : m_enemies) {
+        rSnapshot.Entities.push_back(RenderSnapshot::MakeItem(enemy));
+    }
+    for (const Entity& axe : m_axes) {
+        rSnapshot.Entities.push_back(RenderSnapshot::MakeItem(axe));
+    }
+
+    rSnapshot.DamageTexts = m_DamageTextManager.GetDamageTexts();
+
+    rSnapshot.bLevelEditor = m_eGameMode == LevelEditor;
+    rSnapshot.uSceneRevision = m_uSceneRevision;
+    rSnapshot.vMousePosition = m_vMousePosition;
+    rSnapshot.bCanPlaceTower = m_eGameMode == Play && CanPlaceTowerAtPosition(m_vMousePosition);
+    rSnapshot.iTileOption = m_optionIndex;
+
+    rSnapshot.fDifficulty = m_fDifficulty;
+    rSnapshot.iPlayerGold = m_iPlayerGold;
+    rSnapshot.fGoldPerSecond = m_fGoldPerSecond;
+    rSnapshot.bPlacingSplashTower = m_bPlaceSplashTower;
+    const Entity* pHoveredTower = m_eGameMode == Play ? FindTowerAt(m_vMousePosition) : nullptr;
+    rSnapshot.iHoveredTowerMode = pHoveredTower ? static_cast<int>(pHoveredTower -> m_eTargetingMode) : -1;
+    rSnapshot.bGameOver = m_iPlayerHealth <= 0;
+}
+
+void Game::UpdatePlay() {
+    AllocationTracker::Scope allocationScope("tick");
+    m_fTimeInPlayMode += m_deltaTime.asSeconds();
+    m_fDifficulty += m_deltaTime.asSeconds() / 10.0f;
+    if (m_iPlayerHealth <= 0) return;
+
+    m_DamageTextManager.Update(m_deltaTime);
+
+    const size_t iEnemyCapacity = m_enemies.capacity();
+    const size_t iAxeCapacity = m_axes.capacity();
+    sf::Clock tickClock;
+    sf::Clock phaseClock;
+    UpdateTimers();
+    UpdateTower();
+    m_StressReport.AddPhaseTime(StressReport::Towers, phaseClock.restart());
+    UpdateAxe();
+    m_StressReport.AddPhaseTime(StressReport::Axes, phaseClock.restart());
+    UpdateSpawning();
+    m_StressReport.AddPhaseTime(StressReport::Spawn, phaseClock.restart());
+
+    // Every enemy's heading is gathered up first and normalized as one batch
+    const FrameAllocator<float> floatAllocator(m_FrameArena);
+    FrameVector<float> HeadingX(floatAllocator);
+    FrameVector<float> HeadingY(floatAllocator);
+    const FrameAllocator<int> intAllocator(m_FrameArena);
+    FrameVector<int> SteeredEnemies(intAllocator);
+    HeadingX.reserve(m_enemies.size());
+    HeadingY.reserve(m_enemies.size());
+    SteeredEnemies.reserve(m_enemies.size());
+    FrameVector<int> DistantEnemies(intAllocator);
+
+    // Head for the next tile on the way to the exit. The waypoint is only looked up again when
+    // bLookUp is set, otherwise the one kept from the enemy's current route cell is used.
+    auto steer = [&](int iEnemy, bool bLookUp) {
+        Entity& rEnemy = m_enemies[iEnemy];
+        if (bLookUp) {
+            sf::Vector2f vWaypoint;
+            if (!m_RouteMap.GetNextWaypoint(rEnemy.GetExitIndex(), rEnemy.GetPosition(), vWaypoint)) return;
+            rEnemy.m_iSteeredCell = m_RouteMap.GetRouteCell(rEnemy.GetPosition());
+            rEnemy.m_vWaypoint = vWaypoint;
+        }
+
+        const sf::Vector2f vEnemyToNextTile = rEnemy.m_vWaypoint - rEnemy.GetPosition();
+        HeadingX.push_back(vEnemyToNextTile.x);
+        HeadingY.push_back(vEnemyToNextTile.y);
+        SteeredEnemies.push_back(iEnemy);
+    };
+
+    const sf::FloatRect towerReach = GetTowerReach();
+    for (int i = 0; i < static_cast<int>(m_enemies.size()); i++) {
+        Entity& rEnemy = m_enemies[i];
+        if (rEnemy.IsDeletionRequested()) continue;
+
+        if (m_RouteMap.IsNearExit(rEnemy.GetExitIndex(), rEnemy.GetPosition(), 40.0f)) {
+            // Enemy reached its exit, remove it
+            rEnemy.RequestDeletion();
+            rEnemy.SetVelocity(sf::Vector2f(0.0f, 0.0f));
+            m_iEnemiesLeaked++;
+            //m_iPlayerHealth -= 1;
+            m_fDifficulty *= 0.9f;
+            continue; // Skip to the next enemy
+        }
+
+        // Anywhere in the route cell its waypoint was looked up in, an enemy still heads for that waypoint.
+        // Out of sight and out of reach of every axe it can skip the lookup a few ticks. Its heading is still
+        // worked out from where it is now, so it walks exactly the way a fresh lookup would have sent it.
+        const sf::Vector2f vPosition = rEnemy.GetPosition();
+        const bool bSameCell = rEnemy.m_iSteeredCell >= 0 && rEnemy.m_iSteeredCell == m_RouteMap.GetRouteCell(vPosition);
+        if (bSameCell && !m_ScreenBounds.contains(vPosition.x, vPosition.y) && !towerReach.contains(vPosition.x, vPosition.y)) {
+            DistantEnemies.push_back(i);
+            continue;
+        }
+        steer(i, true);
+    }
+
+    const int iDistantCount = static_cast<int>(DistantEnemies.size());
+    int iFirstDistant = 0;
+    const int iDistantSteered = m_Lod.Select(LodScheduler::Steering, iDistantCount, iFirstDistant);
+    for (int i = 0; i < iDistantCount; i++) {
+        steer(DistantEnemies[(iFirstDistant + i) % iDistantCount], i < iDistantSteered);
+    }
+    m_Metrics.rLodDeferred.Add(iDistantCount - iDistantSteered);
+
+    const float fEnemySpeed = 250.0f;
+    MathHelpers::NormalizeBatch(HeadingX.data(), HeadingY.data(), static_cast<int>(SteeredEnemies.size()));
+    for (int i = 0; i < static_cast<int>(SteeredEnemies.size()); i++) {
+        m_enemies[SteeredEnemies[i]].SetVelocity(sf::Vector2f(HeadingX[i], HeadingY[i]) * fEnemySpeed);
+    }
+    UpdateCrowdSeparation();
+    m_StressReport.AddPhaseTime(StressReport::Steering, phaseClock.restart());
+    if (m_StressSettings.bValidatePhysics) {
+        const float fTolerance = 0.01f;
+        const string divergence = UpdatePhysicsValidated(fTolerance);
+        if (!divergence.empty() && m_iPhysicsDivergences++ == 0) {
+            cout << "Physics diverged from the reference on tick " << m_StressReport.GetTickCount() << ": " << divergence << "\n";
+        }
+    } else {
+        UpdatePhysics();
+    }
+    m_StressReport.AddPhaseTime(StressReport::Physics, phaseClock.restart());
+    ApplyDamageEvents();
+    m_StressReport.AddPhaseTime(StressReport::Damage, phaseClock.restart());
+    CheckForDeletionRequest();
+    m_StressReport.AddPhaseTime(StressReport::Deletion, phaseClock.restart());
+
+    m_fGoldPerSecondTimer += m_deltaTime.asSeconds();
+    if (m_fGoldPerSecondTimer > 0.05f) {
+        m_fGoldPerSecond = m_fGoldPerSecond * 0.9f + 0.1f * m_iGoldGainedThisUpdate / m_fGoldPerSecondTimer;
+        m_fGoldPerSecondTimer = 0.0f;
+        m_iGoldGainedThisUpdate = 0;
+    }
+
+    PublishMetrics(tickClock.getElapsedTime(), iEnemyCapacity, iAxeCapacity);
+}
+
+void Game::PublishMetrics(const sf::Time& tickTime, size_t iEnemyCapacity, size_t iAxeCapacity) {
+    m_Metrics.rTicks.Add(1);
+    m_Metrics.rLiveEnemies.Set(static_cast<double>(m_enemies.size()));
+    m_Metrics.rLiveAxes.Set(static_cast<double>(m_axes.size()));
+    m_Metrics.rTowers.Set(static_cast<double>(m_Towers.size()));
+    m_Metrics.rRoutedSpawns.Set(m_RouteMap.GetSpawnCount());
+    m_Metrics.rExits.Set(m_RouteMap.GetExitCount());
+    m_Metrics.rFrameArenaBytes.Set(static_cast<double>(m_FrameArena.GetBytesUsed()));
+    m_Metrics.rFrameArenaOverflows.Set(m_FrameArena.GetOverflowCount());
+    m_Metrics.rGoldPerSecond.Set(m_fGoldPerSecond);
+    m_Metrics.rTickSeconds.Observe(tickTime.asSeconds());
+
+    if (m_enemies.capacity() != iEnemyCapacity) m_Metrics.rStorageGrowths.Add(1);
+    if (m_axes.capacity() != iAxeCapacity) m_Metrics.rStorageGrowths.Add(1);
+}
+
+void Game::UpdateSpawning() {
+    AllocationTracker::Scope allocationScope("spawn");
+    if (!m_RouteMap.HasRoutes()) return;
+
+    if (!m_StressSettings.bEnabled) {
+        const int iMaxEnemies = 30;
+        if (m_enemies.size() >= iMaxEnemies) return;
+
+        //Speed up the Spawn Rate after 5 seconds
+        float fSpawnRate = m_fDifficulty;
+        // After 1 minutes, the spawn rate will be 2.2f
+        m_fSpawnTimer += m_deltaTime.asSeconds() * fSpawnRate;
+        if (m_fSpawnTimer > 1.0f) {
+            SpawnEnemy();
+            m_fSpawnTimer = 0.0f;
+        }
+        return;
+    }
+
+    // Stress mode ramps the spawn rate up linearly until it hits the cap
+    const float fSpawnRate = std::min(m_StressSettings.fStartSpawnRate + m_StressSettings.fSpawnRateRamp * m_fTimeInPlayMode, m_StressSettings.fMaxSpawnRate);
+    m_fSpawnTimer += m_deltaTime.asSeconds() * fSpawnRate;
+
+    while (m_fSpawnTimer >= 1.0f) {
+        if (m_iEnemiesSpawned >= m_StressSettings.iSpawnBudget || GetLiveEntityCount() >= m_StressSettings.iMaxEntities) {
+            // Don't bank spawns while we are held back
+            m_fSpawnTimer = 1.0f;
+            break;
+        }
+        SpawnEnemy();
+        m_fSpawnTimer -= 1.0f;
+    }
+}
+
+void Game::SpawnEnemy() {
+    Entity& newEnemy = m_enemies.emplace_back(m_EnemyPrototype);
+    // Any spawn with a way out, heading for the exit closest to it
+    std::uniform_int_distribution<int> spawnDistribution(0, m_RouteMap.GetSpawnCount() - 1);
+    const int iSpawn = spawnDistribution(m_Rng);
+    newEnemy.SetPosition(m_RouteMap.GetSpawnPosition(iSpawn));
+    newEnemy.SetExitIndex(m_RouteMap.GetSpawnExit(iSpawn));
+    m_iEnemiesSpawned++;
+}
+
+int Game::GetLiveEntityCount() const {
+    return static_cast<int>(m_enemies.size() + m_axes.size());
+}
+
+void Game::UpdateTower() {
+    AllocationTracker::Scope allocationScope("towers");
+    // Ordered once a tick and shared by every tower, so most modes pick their target in constant time
+    m_ProgressIndex.Update(m_enemies, m_RouteMap);
+    if (m_enemies.empty()) return; // Reloaded towers wait until there is something to throw at
+    bool bEnemyGridBuilt = false;
+
+    // Index order, so a restored snapshot throws in the same order as the match it came from
+    sort(m_ReadyTowers.begin(), m_ReadyTowers.end());
+    int iStillReady = 0;
+    for (int iReady = 0; iReady < static_cast<int>(m_ReadyTowers.size()); iReady++) {
+        const int iTower = m_ReadyTowers[iReady];
+        Entity& tower = m_Towers[iTower];
+
+        // The grid is from before last tick's deletions, only rebuild it when a tower needs it
+        if (tower.m_eTargetingMode == Entity::TargetingMode::Closest && !bEnemyGridBuilt) {
+            BuildEnemyGrid();
+            bEnemyGridBuilt = true;
+        }
+        Entity* pTarget = &m_enemies[FindTarget(tower)];
+
+        if (m_StressSettings.bEnabled && GetLiveEntityCount() >= m_StressSettings.iMaxEntities) {
+            m_ReadyTowers[iStillReady++] = iTower;
+            continue; // Hold fire until there is room for another axe
+        }
+
+        // Rotate the tower to face the enemy
+        sf::Vector2f vTowerToEnemy = pTarget -> GetPosition() - tower.GetPosition();
+        float fAngle = MathHelpers::Angle(vTowerToEnemy);
+        tower.SetRotation(fAngle);
+
+        //Create an axe and set its velocity
+		Entity& newAxe = m_axes.emplace_back(m_AxePrototype);
+        newAxe.SetPosition(tower.GetPosition());
+        vTowerToEnemy = MathHelpers::normalize(vTowerToEnemy);
+        newAxe.SetVelocity(vTowerToEnemy * AxeSpeed);
+        if (tower.m_fSplashRadius > 0.0f) {
+            newAxe.m_fSplashRadius = tower.m_fSplashRadius;
+            newAxe.SetColor(tower.GetColor());
+        }
+        newAxe.m_iTimerDueTick = m_AxeTimers.GetNow() + AxeLifetimeTicks;
+        newAxe.m_iTimerHandle = m_AxeTimers.Schedule(newAxe.m_iTimerDueTick, static_cast<int>(m_axes.size()) - 1);
+        m_iAxesThrown++;
+
+        //Reset the axe throw
+        tower.m_iTimerDueTick = m_TowerTimers.GetNow() + TowerReloadTicks;
+        tower.m_iTimerHandle = m_TowerTimers.Schedule(tower.m_iTimerDueTick, iTower);
+    }
+    m_ReadyTowers.resize(iStillReady);
+}
+
+sf::FloatRect Game::GetTowerReach() const {
+    if (m_Towers.empty()) return sf::FloatRect();
+
+    sf::Vector2f vMin = m_Towers[0].GetPosition();
+    sf::Vector2f vMax = vMin;
+    for (const Entity& tower : m_Towers) {
+        vMin.x = min(vMin.x, tower.GetPosition().x);
+        vMin.y = min(vMin.y, tower.GetPosition().y);
+        vMax.x = max(vMax.x, tower.GetPosition().x);
+        vMax.y = max(vMax.y, tower.GetPosition().y);
+    }
+
+    const float fAxeRange = AxeSpeed * AxeLifetimeTicks * TimerTickSeconds;
+    return sf::FloatRect(vMin.x - fAxeRange, vMin.y - fAxeRange, vMax.x - vMin.x + fAxeRange * 2, vMax.y - vMin.y + fAxeRange * 2);
+}
+
+void Game::UpdateTimers() {
+    // Whole ticks only, the rest carries over. The small bias keeps a 1/60 s update from
+    // rounding down to one tick and catching up with three on the next.
+    m_fTimerRemainder += m_deltaTime.asSeconds();
+    const int iTicks = static_cast<int>(m_fTimerRemainder / TimerTickSeconds + 0.001f);
+    m_fTimerRemainder -= iTicks * TimerTickSeconds;
+    const int iNow = m_TowerTimers.GetNow() + iTicks;
+
+    m_ExpiredTimers.clear();
+    m_TowerTimers.Advance(iNow, m_ExpiredTimers);
+    for (int iTower : m_ExpiredTimers) {
+        m_Towers[iTower].m_iTimerHandle = -1;
+        m_ReadyTowers.push_back(iTower);
+    }
+
+    m_ExpiredTimers.clear();
+    m_AxeTimers.Advance(iNow, m_ExpiredTimers);
+    for (int iAxe : m_ExpiredTimers) {
+        m_axes[iAxe].m_iTimerHandle = -1;
+        m_axes[iAxe].RequestDeletion();
+    }
+}
+
+void Game::ResetTimers(int iNow) {
+    m_TowerTimers.Reset(iNow);
+    m_AxeTimers.Reset(iNow);
+    m_fTimerRemainder = 0.0f;
+    m_ReadyTowers.clear();
+}
+
+void Game::RescheduleTimers() {
+    // Towers that already reloaded are parked rather than filed, the wheel would fire them straight away
+    for (int i = 0; i < static_cast<int>(m_Towers.size()); i++) {
+        Entity& tower = m_Towers[i];
+        if (tower.m_iTimerDueTick > m_TowerTimers.GetNow()) {
+            tower.m_iTimerHandle = m_TowerTimers.Schedule(tower.m_iTimerDueTick, i);
+        }
+        else {
+            tower.m_iTimerHandle = -1;
+            m_ReadyTowers.push_back(i);
+        }
+    }
+    for (int i = 0; i < static_cast<int>(m_axes.size()); i++) {
+        m_axes[i].m_iTimerHandle = m_AxeTimers.Schedule(m_axes[i].m_iTimerDueTick, i);
+    }
+}
+
+int Game::FindTarget(const Entity& rTower) {
+    switch (rTower.m_eTargetingMode) {
+    case Entity::TargetingMode::First:
+        return m_ProgressIndex.GetFirst();
+    case Entity::TargetingMode::Last:
+        return m_ProgressIndex.GetLast();
+    case Entity::TargetingMode::Strongest:
+        return m_ProgressIndex.GetStrongest();
+    default:
+        return FindClosestEnemy(rTower.GetPosition());
+    }
+}
+
+int Game::FindClosestEnemy(const sf::Vector2f& vPosition) {
+    // Widen the search until something turns up inside it, nothing outside can be closer then
+    const float fMaxSearchRadius = m_EnemyGrid.GetCellSize() * 8;
+    for (float fRadius = m_EnemyGrid.GetCellSize(); fRadius <= fMaxSearchRadius; fRadius *= 2) {
+        int iClosestEnemy = -1;
+        float fClosestDistanceSquared = fRadius * fRadius;
+        m_EnemyGrid.ForEachNear(vPosition, fRadius, [&](int iEnemy) {
+            const sf::Vector2f vOffset = m_enemies[iEnemy].GetPosition() - vPosition;
+            const float fDistanceSquared = vOffset.x * vOffset.x + vOffset.y * vOffset.y;
+            // Lowest index wins ties, so the grid's bucket order doesn't matter
+            if (fDistanceSquared < fClosestDistanceSquared
+                || (fDistanceSquared == fClosestDistanceSquared && iEnemy < iClosestEnemy)) {
+                fClosestDistanceSquared = fDistanceSquared;
+                iClosestEnemy = iEnemy;
+            }
+            return true;
+        });
+        if (iClosestEnemy >= 0) return iClosestEnemy;
+    }
+
+    // Nobody nearby, measure everyone
+    const FrameAllocator<float> floatAllocator(m_FrameArena);
+    FrameVector<float> EnemyX(floatAllocator);
+    FrameVector<float> EnemyY(floatAllocator);
+    FrameVector<float> DistancesSquared(m_enemies.size(), 0.0f, floatAllocator);
+    EnemyX.reserve(m_enemies.size());
+    EnemyY.reserve(m_enemies.size());
+    for (const Entity& enemy : m_enemies) {
+        EnemyX.push_back(enemy.GetPosition().x);
+        EnemyY.push_back(enemy.GetPosition().y);
+    }
+    MathHelpers::DistanceSquaredBatch(EnemyX.data(), EnemyY.data(), static_cast<int>(EnemyX.size()), vPosition, DistancesSquared.data());
+    return static_cast<int>(std::min_element(DistancesSquared.begin(), DistancesSquared.end()) - DistancesSquared.begin());
+}
+
+Entity* Game::FindTowerAt(const sf::Vector2f& vPosition) {
+    for (Entity& tower : m_Towers) {
+        const sf::Vector2f vOffset = tower.GetPosition() - vPosition;
+        const float fRadius = tower.GetPhysicsData().m_fRadius;
+        if (vOffset.x * vOffset.x + vOffset.y * vOffset.y < fRadius * fRadius) {
+            return &tower;
+        }
+    }
+    return nullptr;
+}
+
+void Game::UpdateAxe() {
+    AllocationTracker::Scope allocationScope("axes");
+    // Running out of time is up to m_AxeTimers, all that is left here is the spin. The spin
+    // follows from the axe's age, so an axe off screen can skip ticks and still look right later.
+    auto spin = [&](Entity& rAxe) {
+        const int iAgeTicks = m_AxeTimers.GetNow() - (rAxe.m_iTimerDueTick - AxeLifetimeTicks);
+        const float fAgeSeconds = iAgeTicks * TimerTickSeconds + m_fTimerRemainder;
+        rAxe.SetRotation(fmod(fAgeSeconds * AxeSpinDegreesPerSecond, 360.0f));
+    };
+
+    const FrameAllocator<int> intAllocator(m_FrameArena);
+    FrameVector<int> HiddenAxes(intAllocator);
+    for (int i = 0; i < static_cast<int>(m_axes.size()); i++) {
+        const sf::Vector2f vPosition = m_axes[i].GetPosition();
+        if (m_ScreenBounds.contains(vPosition.x, vPosition.y)) {
+            spin(m_axes[i]);
+        } else {
+            HiddenAxes.push_back(i);
+        }
+    }
+
+    int iFirstHidden = 0;
+    const int iHiddenSpun = m_Lod.Select(LodScheduler::AxeSpin, static_cast<int>(HiddenAxes.size()), iFirstHidden);
+    for (int i = 0; i < iHiddenSpun; i++) {
+        spin(m_axes[HiddenAxes[(iFirstHidden + i) % HiddenAxes.size()]]);
+    }
+    m_Metrics.rLodDeferred.Add(HiddenAxes.size() - iHiddenSpun);
+}
+
+void Game::ApplyDamageEvents() {
+    AllocationTracker::Scope allocationScope("damage");
+    // Each explosion becomes a hit on every enemy it reaches, then they all merge with the direct hits.
+    // Physics left the enemy grid where everyone is now, so an explosion only looks at its neighbours.
+    for (const SplashEvent& splashEvent : m_DamageEvents.GetSplashes()) {
+        m_EnemyGrid.ForEachNear(splashEvent.vCenter, splashEvent.fRadius + m_fLargestEnemyRadius, [&](int iEnemy) {
+            Entity& rEnemy = m_enemies[iEnemy];
+            const sf::Vector2f vOffset = rEnemy.GetPosition() - splashEvent.vCenter;
+            const float fReach = splashEvent.fRadius + rEnemy.GetPhysicsData().m_fRadius;
+            if (vOffset.x * vOffset.x + vOffset.y * vOffset.y >= fReach * fReach) return true;
+
+            m_DamageEvents.AddDamage(rEnemy, splashEvent.iDamage, MathHelpers::normalize(vOffset) * splashEvent.fKnockback);
+            return true;
+        });
+    }
+    m_DamageEvents.ClearSplashes();
+
+    m_DamageEvents.MergeByTarget();
+
+    for (const DamageEvent& damageEvent : m_DamageEvents.GetEvents()) {
+        Entity& rTarget = *damageEvent.pTarget;
+        const bool bWasAlive = !rTarget.IsDeletionRequested();
+
+        rTarget.AddImpulse(damageEvent.vKnockback);
+        rTarget.DealDamage(damageEvent.iDamage);
+        if (!m_bHeadless) {
+            m_DamageTextManager.AddDamageText(damageEvent.iDamage, rTarget.GetPosition());
+        }
+
+        if (bWasAlive && rTarget.IsDeletionRequested()) {
+            // Enemy killed this tick
+            m_iEnemiesKilled++;
+            AddGold(1);
+        }
+    }
+    m_DamageEvents.Clear();
+}
+
+void Game::CheckForDeletionRequest() {
+    AllocationTracker::Scope allocationScope("deletion");
+    // Kept in order, and every axe that moves tells its timer where it went
+    int iKeptAxes = 0;
+    for (int i = 0; i < static_cast<int>(m_axes.size()); i++) {
+        Entity& axe = m_axes[i];
+        if (axe.IsDeletionRequested()) {
+            if (axe.m_iTimerHandle >= 0) m_AxeTimers.Cancel(axe.m_iTimerHandle);
+            continue;
+        }
+        if (iKeptAxes != i) {
+            m_axes[iKeptAxes] = axe;
+            if (axe.m_iTimerHandle >= 0) m_AxeTimers.SetPayload(axe.m_iTimerHandle, iKeptAxes);
+        }
+        iKeptAxes++;
+    }
+    m_axes.erase(m_axes.begin() + iKeptAxes, m_axes.end());
+
+    // Compacted in one pass keeping the order, and the targeting index is told where everyone went
+    const FrameAllocator<int> intAllocator(m_FrameArena);
+    FrameVector<int> NewEnemyIndices(m_enemies.size(), -1, intAllocator);
+    int iKept = 0;
+    for (int i = 0; i < static_cast<int>(m_enemies.size()); i++) {
+        if (m_enemies[i].IsDeletionRequested()) continue;
+        if (iKept != i) {
+            m_enemies[iKept] = m_enemies[i];
+        }
+        NewEnemyIndices[i] = iKept;
+        iKept++;
+    }
+    m_enemies.erase(m_enemies.begin() + iKept, m_enemies.end());
+    m_ProgressIndex.Remap(NewEnemyIndices.data());
+}
+
+void Game::UpdateLevelEditor() {
+	m_enemies.clear(); // Clear enemies in level editor mode
+    m_axes.clear();
+    if (!m_Towers.empty()) {
+        m_Towers.clear();
+        m_PlacementMap.ClearTowers();
+    }
+    ResetTimers(0);
+    m_Lod.ResetCursors();
+    
+    m_iPlayerGold = 10;
+    m_iPlayerHealth = 10;
+    m_iGoldGainedThisUpdate = 0;
+    m_fTimeInPlayMode = 0.0f;
+    m_fDifficulty = 1.0f;
+    m_fGoldPerSecond = 0.0f;
+    m_fGoldPerSecondTimer = 0.0f;
+    m_fSpawnTimer = 0.0f;
+    m_iEnemiesSpawned = 0;
+    m_iAxesThrown = 0;
+    m_iEnemiesKilled = 0;
+    m_iEnemiesLeaked = 0;
+    m_iGoldEarned = 0;
+}
+
+void Game::UpdateCrowdSeparation() {
+    AllocationTracker::Scope allocationScope("crowd");
+    // Each enemy looks at no more than this many neighbours, so dense crowds cost the same per enemy
+    const int iMaxNeighbours = 8;
+    // Fraction of the overlap resolved each tick, below 1 so crowds settle instead of jittering
+    const float fSeparationStrength = 0.5f;
+
+    BuildEnemyGrid();
+
+    for (int i = 0; i < static_cast<int>(m_enemies.size()); i++) {
+        Entity& rEnemy = m_enemies[i];
+        const sf::Vector2f vPosition = rEnemy.GetPosition();
+        const float fRadius = rEnemy.GetPhysicsData().m_fRadius;
+
+        sf::Vector2f vSeparation(0.0f, 0.0f);
+        int iNeighbours = 0;
+
+        m_EnemyGrid.ForEachNear(vPosition, fRadius * 2, [&](int iOther) {
+            if (iOther == i) return true;
+
+            const Entity& rOther = m_enemies[iOther];
+            const float fSumOfRadii = fRadius + rOther.GetPhysicsData().m_fRadius;
+            sf::Vector2f vOtherToEnemy = vPosition - rOther.GetPosition();
+            const float fDistanceSquared = vOtherToEnemy.x * vOtherToEnemy.x + vOtherToEnemy.y * vOtherToEnemy.y;
+            if (fDistanceSquared >= fSumOfRadii * fSumOfRadii) return true;
+
+            float fDistance = std::sqrt(fDistanceSquared);
+            if (fDistance == 0.0f) {
+                // Stacked exactly on top of each other, split them apart along x by index
+                vOtherToEnemy = sf::Vector2f(i < iOther ? -1.0f : 1.0f, 0.0f);
+                fDistance = 1.0f;
+            }
+
+            vSeparation += vOtherToEnemy / fDistance * (fSumOfRadii - fDistance) * 0.5f;
+            iNeighbours++;
+            return iNeighbours < iMaxNeighbours;
+        });
+
+        if (iNeighbours > 0) {
+            rEnemy.AddImpulse(vSeparation * fSeparationStrength);
+        }
+    }
+}
+
+void Game::BuildEnemyGrid() {
+    m_EnemyGrid.Clear();
+    m_fLargestEnemyRadius = 0.0f;
+    for (int i = 0; i < static_cast<int>(m_enemies.size()); i++) {
+        m_EnemyGrid.Insert(i, m_enemies[i].GetPosition());
+        m_fLargestEnemyRadius = std::max(m_fLargestEnemyRadius, m_enemies[i].GetPhysicsData().m_fRadius);
+    }
+    m_EnemyGrid.Build();
+}
+
+void Game::UpdatePhysics() {
+    AllocationTracker::Scope allocationScope("physics");
+	const float fMaxDeltaTime = 0.1f; // Cap the delta time to prevent large jumps
+	const float fDeltaTime = std::min(m_deltaTime.asSeconds(), fMaxDeltaTime);
+
+    const FrameAllocator<Entity*> allocator(m_FrameArena);
+    FrameVector <Entity*> AllEntities(allocator);
+    AllEntities.reserve(m_Towers.size() + m_enemies.size() + m_axes.size());
+
+    for (Entity& tower : m_Towers) {
+        AllEntities.push_back(&tower);
+    }
+
+    for (Entity& enemy : m_enemies) {
+        AllEntities.push_back(&enemy);
+    }
+
+    for (Entity& axe : m_axes) {
+        AllEntities.push_back(&axe);
+    }
+
+    CollisionPairSet CollidedPairs(64, CollisionPairHash(), equal_to<CollisionPair>(), allocator);
+
+    // Everything each interaction mask can collide with, so pairs the layer matrix rules out
+    // never reach the narrowphase. Built the first time a body with that mask moves.
+    const int iNumMasks = 1 << Entity::PhysicsData::NumLayers;
+    FrameVector <FrameVector <Entity*>> CandidatesByMask(iNumMasks, FrameVector <Entity*>(allocator), allocator);
+    bool bCandidatesBuilt[iNumMasks] = {};
+    FrameVector <int> NearWalls(allocator);
+
+    // Counted locally and published once, the metrics are atomics
+    uint64_t iPairsTested = 0;
+    uint64_t iCollisionsResolved = 0;
+
+    if (m_bWallsOutOfDate) BuildWalls();
+
+    // Dynamic bodies first, they push each other around and never test against sensors
+    for (Entity* entity : AllEntities) {
+
+        if (entity -> GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic) {
+            const int iMask = entity -> GetPhysicsData().m_iInteractionMask & (iNumMasks - 1);
+            if (!bCandidatesBuilt[iMask]) {
+                for (Entity* otherEntity : AllEntities) {
+                    if (otherEntity -> GetPhysicsData().m_eType != Entity::PhysicsData::Type::Sensor
+                        && entity -> GetPhysicsData().CanInteractWith(otherEntity -> GetPhysicsData())) {
+                        CandidatesByMask[iMask].push_back(otherEntity);
+                    }
+                }
+                bCandidatesBuilt[iMask] = true;
+            }
+            const FrameVector<Entity*>& Candidates = CandidatesByMask[iMask];
+            const bool bCollidesWithWalls = (iMask & Entity::PhysicsData::Layer::Wall) != 0;
+            const Entity::PhysicsData& rPhysicsData = entity -> GetPhysicsData();
+            const float fWallReach = rPhysicsData.m_eShape == Entity::PhysicsData::Shape::Circle
+                ? rPhysicsData.m_fRadius
+                : std::sqrt(rPhysicsData.m_fWidth * rPhysicsData.m_fWidth + rPhysicsData.m_fHeight * rPhysicsData.m_fHeight) / 2;
+
+            const sf::Vector2f vMovement = entity -> GetVelocity() * fDeltaTime + entity -> GetImpulse();
+            entity -> ClearImpulse();
+
+            // Fast bodies are moved in several smaller steps so they cannot skip over anything
+            const int iSubSteps = GetSubStepCount(*entity, vMovement);
+            const sf::Vector2f vSubStepMovement = vMovement / static_cast<float>(iSubSteps);
+
+            for (int iSubStep = 0; iSubStep < iSubSteps; iSubStep++) {
+                entity -> move(vSubStepMovement);
+
+                // Check collisions
+                for (Entity* otherEntity : Candidates) {
+                    if (entity == otherEntity) continue; // Skip self-collision
+
+                    const Narrowphase::Contact contact = Narrowphase::FindContact(*entity, *otherEntity);
+                    iPairsTested++;
+
+                    if (contact.bColliding && CollidedPairs.insert(MakeCollisionPair(*entity, *otherEntity)).second) {
+                        entity -> OnCollision(*otherEntity, m_DamageEvents);
+                        otherEntity -> OnCollision(*entity, m_DamageEvents);
+                        if (m_pPhysicsTrace) m_pPhysicsTrace -> AddCollisionEvent(GetPhysicsId(*entity), GetPhysicsId(*otherEntity));
+                    }
+                    if (contact.bColliding) {
+                        iCollisionsResolved++;
+                        if (m_pPhysicsTrace) m_pPhysicsTrace -> AddContact(GetPhysicsId(*entity), GetPhysicsId(*otherEntity));
+                    }
+                    ProcessCollision(*entity, *otherEntity, contact);
+                }
+
+                if (bCollidesWithWalls) {
+                    // Walls never move, the whole push goes to the body. Getting out of one wall can take a body
+                    // out of the next, so they are pushed out of in wall order, not the order the cells were scanned in.
+                    NearWalls.clear();
+                    m_WallMap.ForEachNear(entity -> GetPosition(), fWallReach, [&](const WallMap::Wall& rWall) {
+                        NearWalls.push_back(m_WallMap.GetWallIndex(rWall));
+                        return true;
+                    });
+                    std::sort(NearWalls.begin(), NearWalls.end());
+
+                    for (int iWall : NearWalls) {
+                        const WallMap::Wall& rWall = m_WallMap.GetWall(iWall);
+                        const Narrowphase::Contact contact = Narrowphase::FindContact(entity -> GetPosition(), entity -> GetPhysicsData(), rWall.vPosition, rWall.shape);
+                        iPairsTested++;
+                        if (contact.bColliding) {
+                            iCollisionsResolved++;
+                            entity -> move(-contact.vNormal * contact.fDepth);
+                            if (m_pPhysicsTrace) m_pPhysicsTrace -> AddContact(GetPhysicsId(*entity), -1 - iWall);
+                        }
+                    }
+                }
+
+                if (entity -> IsDeletionRequested()) break;
+            }
+        }
+    }
+
+    // Sensors go last so they see where everything ended up. Enemies come from the grid,
+    // rebuilt now that they have moved, instead of every sensor walking the whole list.
+    BuildEnemyGrid();
+    FrameVector <FrameVector <Entity*>> SensorCandidatesByMask(iNumMasks, FrameVector <Entity*>(allocator), allocator);
+    bool bSensorCandidatesBuilt[iNumMasks] = {};
+
+    for (Entity* entity : AllEntities) {
+
+        if (entity -> GetPhysicsData().m_eType == Entity::PhysicsData::Type::Sensor) {
+            const int iMask = entity -> GetPhysicsData().m_iInteractionMask & (iNumMasks - 1);
+            if (!bSensorCandidatesBuilt[iMask]) {
+                // Sensors never test each other, and enemies are looked up in the grid
+                for (Entity* otherEntity : AllEntities) {
+                    if (otherEntity -> GetPhysicsData().m_eType != Entity::PhysicsData::Type::Sensor
+                        && !otherEntity -> GetPhysicsData().IsInAnyLayer(Entity::PhysicsData::Layer::Enemy)
+                        && entity -> GetPhysicsData().CanInteractWith(otherEntity -> GetPhysicsData())) {
+                        SensorCandidatesByMask[iMask].push_back(otherEntity);
+                    }
+                }
+                bSensorCandidatesBuilt[iMask] = true;
+            }
+            const FrameVector<Entity*>& Candidates = SensorCandidatesByMask[iMask];
+            const bool bSensesEnemies = (entity -> GetPhysicsData().m_iInteractionMask & Entity::PhysicsData::Layer::Enemy) != 0;
+
+            const sf::Vector2f vMovement = entity -> GetVelocity() * fDeltaTime + entity -> GetImpulse();
+            entity -> ClearImpulse();
+
+            const int iSubSteps = GetSubStepCount(*entity, vMovement);
+            const sf::Vector2f vSubStepMovement = vMovement / static_cast<float>(iSubSteps);
+
+            for (int iSubStep = 0; iSubStep < iSubSteps; iSubStep++) {
+                const sf::Vector2f vPreviousPosition = entity -> GetPosition();
+                entity -> move(vSubStepMovement);
+
+                // Overlaps are only reported, a sensor never pushes anything or gets pushed
+                auto SenseOverlap = [&](Entity& otherEntity) {
+                    iPairsTested++;
+                    if (!isSweptColiding(*entity, vPreviousPosition, otherEntity)) return;
+                    if (m_pPhysicsTrace) m_pPhysicsTrace -> AddContact(GetPhysicsId(*entity), GetPhysicsId(otherEntity));
+                    if (CollidedPairs.insert(MakeCollisionPair(*entity, otherEntity)).second) {
+                        entity -> OnCollision(otherEntity, m_DamageEvents);
+                        otherEntity.OnCollision(*entity, m_DamageEvents);
+                        if (m_pPhysicsTrace) m_pPhysicsTrace -> AddCollisionEvent(GetPhysicsId(*entity), GetPhysicsId(otherEntity));
+                    }
+                };
+
+                for (Entity* otherEntity : Candidates) {
+                    SenseOverlap(*otherEntity);
+                }
+
+                if (bSensesEnemies) {
+                    // Anything the swept step could touch is within this distance of its middle
+                    const sf::Vector2f vMiddle = vPreviousPosition + vSubStepMovement * 0.5f;
+                    const float fReach = MathHelpers::flength(vSubStepMovement) * 0.5f
+                        + entity -> GetPhysicsData().m_fRadius + m_fLargestEnemyRadius;
+                    m_EnemyGrid.ForEachNear(vMiddle, fReach, [&](int iEnemy) {
+                        Entity& rEnemy = m_enemies[iEnemy];
+                        if (entity -> GetPhysicsData().CanInteractWith(rEnemy.GetPhysicsData())) {
+                            SenseOverlap(rEnemy);
+                        }
+                        return true;
+                    });
+                }
+
+                // A projectile that already hit something is gone, it should not hit again further along
+                if (entity -> IsDeletionRequested()) break;
+            }
+        }
+    }
+
+    m_Metrics.rPairsTested.Add(iPairsTested);
+    m_Metrics.rCollisionsResolved.Add(iCollisionsResolved);
+}
+
+namespace {
+    // The reference's own shape tests, written out plainly so a mistake in Narrowphase or
+    // ProcessCollision shows up as a divergence instead of being made by both runs
+    Narrowphase::Contact ReferenceContact(const sf::Vector2f& vPosition1, const Entity::PhysicsData& rShape1,
+        const sf::Vector2f& vPosition2, const Entity::PhysicsData& rShape2) {
+        typedef Entity::PhysicsData::Shape Shape;
+        Narrowphase::Contact contact = { false, sf::Vector2f(0.0f, 0.0f), 0.0f };
+
+        if (rShape1.m_eShape == Shape::Rectangle && rShape2.m_eShape == Shape::Circle) {
+            contact = ReferenceContact(vPosition2, rShape2, vPosition1, rShape1);
+            contact.vNormal = -contact.vNormal;
+            return contact;
+        }
+
+        if (rShape1.m_eShape == Shape::Rectangle) {
+            // Two boxes, pushed apart along the axis they overlap least on
+            const float fOverlapX = (rShape1.m_fWidth + rShape2.m_fWidth) / 2 - std::abs(vPosition2.x - vPosition1.x);
+            const float fOverlapY = (rShape1.m_fHeight + rShape2.m_fHeight) / 2 - std::abs(vPosition2.y - vPosition1.y);
+            if (fOverlapX <= 0.0f || fOverlapY <= 0.0f) return contact;
+            contact.bColliding = true;
+            if (fOverlapX < fOverlapY) {
+                contact.vNormal.x = vPosition1.x < vPosition2.x ? 1.0f : -1.0f;
+                contact.fDepth = fOverlapX;
+            } else {
+                contact.vNormal.y = vPosition1.y < vPosition2.y ? 1.0f : -1.0f;
+                contact.fDepth = fOverlapY;
+            }
+            return contact;
+        }
+
+        // A circle against the nearest point of the other shape, its centre for a circle
+        sf::Vector2f vNearest = vPosition2;
+        float fReach = rShape1.m_fRadius;
+        if (rShape2.m_eShape == Shape::Circle) {
+            fReach += rShape2.m_fRadius;
+        } else {
+            vNearest.x = std::max(vPosition2.x - rShape2.m_fWidth / 2, std::min(vPosition1.x, vPosition2.x + rShape2.m_fWidth / 2));
+            vNearest.y = std::max(vPosition2.y - rShape2.m_fHeight / 2, std::min(vPosition1.y, vPosition2.y + rShape2.m_fHeight / 2));
+        }
+
+        const float fDx = vNearest.x - vPosition1.x;
+        const float fDy = vNearest.y - vPosition1.y;
+        const float fDistance = std::sqrt(fDx * fDx + fDy * fDy);
+        if (fDistance >= fReach) return contact;
+
+        contact.bColliding = true;
+        if (fDistance > 0.0f) {
+            contact.vNormal = sf::Vector2f(fDx / fDistance, fDy / fDistance);
+        }
+        contact.fDepth = fReach - fDistance;
+        return contact;
+    }
+
+    // Whether a circle moving from vStart to vEnd passed within reach of another circle
+    bool ReferenceSweptOverlap(const sf::Vector2f& vStart, const sf::Vector2f& vEnd, float fRadius,
+        const sf::Vector2f& vOtherPosition, float fOtherRadius) {
+        const float fSegmentX = vEnd.x - vStart.x;
+        const float fSegmentY = vEnd.y - vStart.y;
+        const float fSegmentLengthSquared = fSegmentX * fSegmentX + fSegmentY * fSegmentY;
+        float t = 0.0f;
+        if (fSegmentLengthSquared > 0.0f) {
+            t = ((vOtherPosition.x - vStart.x) * fSegmentX + (vOtherPosition.y - vStart.y) * fSegmentY) / fSegmentLengthSquared;
+            t = std::max(0.0f, std::min(t, 1.0f));
+        }
+        const float fDx = vOtherPosition.x - (vStart.x + fSegmentX * t);
+        const float fDy = vOtherPosition.y - (vStart.y + fSegmentY * t);
+        return std::sqrt(fDx * fDx + fDy * fDy) < fRadius + fOtherRadius;
+    }
+}
+
+void Game::UpdatePhysicsReference() {
+    const float fMaxDeltaTime = 0.1f;
+    const float fDeltaTime = std::min(m_deltaTime.asSeconds(), fMaxDeltaTime);
+
+    vector<Entity*> AllEntities;
+    for (Entity& tower : m_Towers) AllEntities.push_back(&tower);
+    for (Entity& enemy : m_enemies) AllEntities.push_back(&enemy);
+    for (Entity& axe : m_axes) AllEntities.push_back(&axe);
+
+    set<CollisionPair> CollidedPairs;
+    auto Collide = [&](Entity& entity, Entity& otherEntity) {
+        if (m_pPhysicsTrace) m_pPhysicsTrace -> AddContact(GetPhysicsId(entity), GetPhysicsId(otherEntity));
+        if (CollidedPairs.insert(MakeCollisionPair(entity, otherEntity)).second) {
+            entity.OnCollision(otherEntity, m_DamageEvents);
+            otherEntity.OnCollision(entity, m_DamageEvents);
+            if (m_pPhysicsTrace) m_pPhysicsTrace -> AddCollisionEvent(GetPhysicsId(entity), GetPhysicsId(otherEntity));
+        }
+    };
+
+    if (m_bWallsOutOfDate) BuildWalls();
+
+    for (Entity* entity : AllEntities) {
+        if (entity -> GetPhysicsData().m_eType != Entity::PhysicsData::Type::Dynamic) continue;
+
+        const sf::Vector2f vMovement = entity -> GetVelocity() * fDeltaTime + entity -> GetImpulse();
+        entity -> ClearImpulse();
+        const int iSubSteps = GetSubStepCount(*entity, vMovement);
+
+        for (int iSubStep = 0; iSubStep < iSubSteps; iSubStep++) {
+            entity -> move(vMovement / static_cast<float>(iSubSteps));
+
+            for (Entity* otherEntity : AllEntities) {
+                if (entity == otherEntity) continue;
+                if (otherEntity -> GetPhysicsData().m_eType == Entity::PhysicsData::Type::Sensor) continue;
+                if (!entity -> GetPhysicsData().CanInteractWith(otherEntity -> GetPhysicsData())) continue;
+
+                const Narrowphase::Contact contact = ReferenceContact(entity -> GetPosition(), entity -> GetPhysicsData(),
+                    otherEntity -> GetPosition(), otherEntity -> GetPhysicsData());
+                if (!contact.bColliding) continue;
+                Collide(*entity, *otherEntity);
+
+                // Another dynamic body takes half the push, anything else none of it
+                const sf::Vector2f vPush = contact.vNormal * contact.fDepth;
+                if (otherEntity -> GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic) {
+                    entity -> move(-vPush * 0.5f);
+                    otherEntity -> move(vPush * 0.5f);
+                } else {
+                    entity -> move(-vPush);
+                }
+            }
+
+            if (entity -> GetPhysicsData().m_iInteractionMask & Entity::PhysicsData::Layer::Wall) {
+                for (int iWall = 0; iWall < m_WallMap.GetWallCount(); iWall++) {
+                    const WallMap::Wall& rWall = m_WallMap.GetWall(iWall);
+                    const Narrowphase::Contact contact = ReferenceContact(entity -> GetPosition(), entity -> GetPhysicsData(), rWall.vPosition, rWall.shape);
+                    if (!contact.bColliding) continue;
+                    entity -> move(-contact.vNormal * contact.fDepth);
+                    if (m_pPhysicsTrace) m_pPhysicsTrace -> AddContact(GetPhysicsId(*entity), -1 - iWall);
+                }
+            }
+
+            if (entity -> IsDeletionRequested()) break;
+        }
+    }
+
+    for (Entity* entity : AllEntities) {
+        if (entity -> GetPhysicsData().m_eType != Entity::PhysicsData::Type::Sensor) continue;
+
+        const sf::Vector2f vMovement = entity -> GetVelocity() * fDeltaTime + entity -> GetImpulse();
+        entity -> ClearImpulse();
+        const int iSubSteps = GetSubStepCount(*entity, vMovement);
+
+        for (int iSubStep = 0; iSubStep < iSubSteps; iSubStep++) {
+            const sf::Vector2f vPreviousPosition = entity -> GetPosition();
+            entity -> move(vMovement / static_cast<float>(iSubSteps));
+
+            for (Entity* otherEntity : AllEntities) {
+                if (entity == otherEntity) continue;
+                if (otherEntity -> GetPhysicsData().m_eType == Entity::PhysicsData::Type::Sensor) continue;
+                if (!entity -> GetPhysicsData().CanInteractWith(otherEntity -> GetPhysicsData())) continue;
+
+                const Entity::PhysicsData& rShape = entity -> GetPhysicsData();
+                const Entity::PhysicsData& rOtherShape = otherEntity -> GetPhysicsData();
+                const bool bOverlaps = rShape.m_eShape == Entity::PhysicsData::Shape::Circle && rOtherShape.m_eShape == Entity::PhysicsData::Shape::Circle
+                    ? ReferenceSweptOverlap(vPreviousPosition, entity -> GetPosition(), rShape.m_fRadius, otherEntity -> GetPosition(), rOtherShape.m_fRadius)
+                    : ReferenceContact(entity -> GetPosition(), rShape, otherEntity -> GetPosition(), rOtherShape).bColliding;
+                if (bOverlaps) Collide(*entity, *otherEntity);
+            }
+
+            if (entity -> IsDeletionRequested()) break;
+        }
+    }
+}
+
+string Game::UpdatePhysicsValidated(float fTolerance) {
+    // The reference gets its own copy of everything physics reads or writes
+    vector<Entity> ReferenceTowers = m_Towers;
+    vector<Entity> ReferenceEnemies = m_enemies;
+    vector<Entity> ReferenceAxes = m_axes;
+    DamageEventBuffer ReferenceDamageEvents = m_DamageEvents;
+
+    PhysicsTrace OptimizedTrace;
+    m_pPhysicsTrace = &OptimizedTrace;
+    UpdatePhysics();
+    TracePhysicsBodies(OptimizedTrace);
+
+    // Swapped in for the reference and back again after, so the optimized results are what the tick carries on with
+    m_Towers.swap(ReferenceTowers);
+    m_enemies.swap(ReferenceEnemies);
+    m_axes.swap(ReferenceAxes);
+    std::swap(m_DamageEvents, ReferenceDamageEvents);
+
+    PhysicsTrace ReferenceTrace;
+    m_pPhysicsTrace = &ReferenceTrace;
+    UpdatePhysicsReference();
+    TracePhysicsBodies(ReferenceTrace);
+    m_pPhysicsTrace = nullptr;
+
+    m_Towers.swap(ReferenceTowers);
+    m_enemies.swap(ReferenceEnemies);
+    m_axes.swap(ReferenceAxes);
+    std::swap(m_DamageEvents, ReferenceDamageEvents);
+
+    return PhysicsTrace::FindDivergence(OptimizedTrace, ReferenceTrace, fTolerance);
+}
+
+int Game::GetPhysicsId(const Entity& entity) const {
+    // The lists are contiguous, so the address says which one it is in. Only subtracted once it
+    // is known to be inside, and compared with std::less since the lists are unrelated arrays.
+    auto IndexIn = [&entity](const vector<Entity>& rList) {
+        const std::less<const Entity*> before;
+        const Entity* pEntity = &entity;
+        if (rList.empty() || before(pEntity, rList.data()) || !before(pEntity, rList.data() + rList.size())) return rList.size();
+        return static_cast<size_t>(pEntity - rList.data());
+    };
+    const size_t iTower = IndexIn(m_Towers);
+    if (iTower < m_Towers.size()) return static_cast<int>(iTower);
+    const size_t iEnemy = IndexIn(m_enemies);
+    if (iEnemy < m_enemies.size()) return static_cast<int>(m_Towers.size() + iEnemy);
+    const size_t iAxe = IndexIn(m_axes);
+    assert(iAxe < m_axes.size());
+    return static_cast<int>(m_Towers.size() + m_enemies.size() + iAxe);
+}
+
+void Game::TracePhysicsBodies(PhysicsTrace& rTrace) const {
+    for (int i = 0; i < static_cast<int>(m_Towers.size()); i++) {
+        rTrace.AddBody("tower", i, m_Towers[i].GetPosition(), m_Towers[i].IsDeletionRequested());
+    }
+    for (int i = 0; i < static_cast<int>(m_enemies.size()); i++) {
+        rTrace.AddBody("enemy", i, m_enemies[i].GetPosition(), m_enemies[i].IsDeletionRequested());
+    }
+    for (int i = 0; i < static_cast<int>(m_axes.size()); i++) {
+        rTrace.AddBody("axe", i, m_axes[i].GetPosition(), m_axes[i].IsDeletionRequested());
+    }
+}
+
+Game::CollisionPair Game::MakeCollisionPair(const Entity& entity1, const Entity& entity2) {
+    // Lowest address first, so the order they are passed in doesn't matter
+    return &entity1 < &entity2 ? CollisionPair(&entity1, &entity2) : CollisionPair(&entity2, &entity1);
+}
+
+int Game::GetSubStepCount(const Entity& entity, const sf::Vector2f& vMovement) const {
+    // A body may move this fraction of its size per step before the move is split up
+    const float fMaxStepFractionOfSize = 0.5f;
+    const int iMaxSubSteps = 16;
+
+    const Entity::PhysicsData& rPhysicsData = entity.GetPhysicsData();
+    const float fSize = rPhysicsData.m_eShape == Entity::PhysicsData::Shape::Circle
+        ? rPhysicsData.m_fRadius
+        : std::min(rPhysicsData.m_fWidth, rPhysicsData.m_fHeight) / 2;
+
+    const float fMaxStepLength = fSize * fMaxStepFractionOfSize;
+    if (fMaxStepLength <= 0.0f) return 1;
+
+    const float fMovementLength = MathHelpers::flength(vMovement);
+    const int iSubSteps = static_cast<int>(std::ceil(fMovementLength / fMaxStepLength));
+    return std::clamp(iSubSteps, 1, iMaxSubSteps);
+}
+
+void Game::ProcessCollision(Entity& entity1, Entity& entity2, const Narrowphase::Contact& contact) {
+    assert(entity1.GetPhysicsData().m_eType != Entity::PhysicsData::Type::Static);
+    if (!contact.bColliding) return;
+
+    const bool isEntity2Dynamic = entity2.GetPhysicsData().m_eType == Entity::PhysicsData::Type::Dynamic;
+    if (!isEntity2Dynamic) {
+        // We only need to move entity1
+        entity1.move(-contact.vNormal * contact.fDepth);
+    }
+    else {
+        // Both entities are dynamic, we need to move both of them
+        const sf::Vector2f vEntity1Movement = contact.vNormal * contact.fDepth * 0.5f;
+        entity1.move(-vEntity1Movement);
+        entity2.move(vEntity1Movement);
+    }
+}
+
+bool Game::isColiding(const Entity& entity1, const Entity& entity2) {
+    return Narrowphase::FindContact(entity1, entity2).bColliding;
+}
+
+bool Game::isSweptColiding(const Entity& entity1, const sf::Vector2f& vPreviousPosition, const Entity& entity2) {
+    if (entity1.GetPhysicsData().m_eShape != Entity::PhysicsData::Shape::Circle
+        || entity2.GetPhysicsData().m_eShape != Entity::PhysicsData::Shape::Circle) {
+        // Only circles are swept, the sub-steps keep everything else from tunneling
+        return isColiding(entity1, entity2);
+    }
+
+    // Find where along this step entity1 came closest to entity2
+    const sf::Vector2f vClosestPoint = MathHelpers::ClosestPointOnSegment(vPreviousPosition, entity1.GetPosition(), entity2.GetPosition());
+    const float fDistanceBeeenEntities = MathHelpers::flength(entity2.GetPosition() - vClosestPoint);
+    const float fSumOfRadii = entity1.GetPhysicsData().m_fRadius + entity2.GetPhysicsData().m_fRadius;
+
+    return fDistanceBeeenEntities < fSumOfRadii;
+}
+
+void Game::DrawPlay(const RenderSnapshot& rSnapshot) {
+    for (const RenderSnapshot::Item& item : rSnapshot.Entities) {
+        item.Draw(m_Window);
+    }
+
+    m_DamageTextManager.Draw(m_Window, rSnapshot.DamageTexts);
+
+    // Draw the tower template
+    RenderSnapshot::Item towerTemplate = RenderSnapshot::MakeItem(m_TowerTemplate);
+    towerTemplate.vPosition = rSnapshot.vMousePosition;
+    towerTemplate.color = rSnapshot.bCanPlaceTower ? sf::Color::Green : sf::Color::Red;
+    towerTemplate.Draw(m_Window);
+
+    if (rSnapshot.bGameOver) {
+        //draw the game over text
+        m_Window.draw(m_GameOverText);
+    }
+
+    m_PlayerText.setString("Difficulty: " + to_string(rSnapshot.fDifficulty) + 
+        "\nPlayer's Gold: " + to_string(rSnapshot.iPlayerGold) + 
+        "\nGold Per Second: " + to_string(rSnapshot.fGoldPerSecond) +
+        "\nBuilding: " + (rSnapshot.bPlacingSplashTower ? "Splash tower, " + to_string(SplashTowerCost) : "Tower, " + to_string(TowerCost)) + " gold (Tab to switch)" +
+        (rSnapshot.iHoveredTowerMode >= 0 ? "\nTower Targets: " + string(TargetingModeNames[rSnapshot.iHoveredTowerMode]) + " (right click to change)" : ""));
+    m_Window.draw(m_PlayerText);
+}
+
+void Game::Draw(const RenderSnapshot& rSnapshot) {
+    AllocationTracker::Scope allocationScope("draw");
+	// Erase the previous frame
+    m_Window.clear();
+
+    for (const RenderSnapshot::Item& item : rSnapshot.Tiles) {
+        item.Draw(m_Window);
+    }
+
+    const GameMode eGameMode = rSnapshot.bLevelEditor ? LevelEditor : Play;
+    if (eGameMode != m_eDrawnGameMode) {
+        m_GameModeText.setString(eGameMode == LevelEditor ? "Level Editor Mode" : "Play Mode");
+        m_eDrawnGameMode = eGameMode;
+    }
+	//Draw the game mode text 
+	m_Window.draw(m_GameModeText);
+
+    switch (eGameMode) {
+        case Play:
+            DrawPlay(rSnapshot);
+            break;
+        case LevelEditor:
+            DrawLevelEditor(rSnapshot);
+            break;
+    }
+    m_Window.display();
+}
+
+bool Game::PollWindowInput() {
+    InputEvent inputEvent = {};
+    bool bAnyInput = false;
+
+    // Only the press is sent, holding T doesn't keep switching modes
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::T)) {
+        if (!m_bTwasPressedLastUpdate) {
+            inputEvent.eType = InputEvent::ToggleMode;
+            QueueInput(inputEvent);
+            bAnyInput = true;
+        }
+		m_bTwasPressedLastUpdate = true;
+    }
+    else {
+		m_bTwasPressedLastUpdate = false;
+    }
+
+    sf::Event event;
+    while (m_Window.pollEvent(event)) {
+        bAnyInput = true; // Resizes and focus changes count too, the window may need drawing again
+        switch (event.type) {
+        case sf::Event::Closed:
+            m_Window.close();
+            break;
+        case sf::Event::KeyPressed:
+            // Ctrl+Z undoes, Ctrl+Y or Ctrl+Shift+Z redoes
+            if (event.key.control && event.key.code == sf::Keyboard::Z) {
+                inputEvent.eType = event.key.shift ? InputEvent::Redo : InputEvent::Undo;
+                QueueInput(inputEvent);
+            } else if (event.key.control && event.key.code == sf::Keyboard::Y) {
+                inputEvent.eType = InputEvent::Redo;
+                QueueInput(inputEvent);
+            } else if (event.key.code == sf::Keyboard::Tab) {
+                inputEvent.eType = InputEvent::SwitchTower;
+                QueueInput(inputEvent);
+            }
+            break;
+        case sf::Event::MouseWheelScrolled:
+            if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+                inputEvent.eType = InputEvent::Scroll;
+                inputEvent.eScroll = event.mouseWheelScroll.delta > 0 ? ScrollUp : ScrollDown;
+                QueueInput(inputEvent);
+            }
+            break;
+        }
+    }
+
+    inputEvent.eType = InputEvent::Mouse;
+    inputEvent.vMousePosition = (sf::Vector2f)sf::Mouse::getPosition(m_Window);
+    inputEvent.bLeftButton = sf::Mouse::isButtonPressed(sf::Mouse::Left);
+    inputEvent.bRightButton = sf::Mouse::isButtonPressed(sf::Mouse::Right);
+    QueueInput(inputEvent);
+
+    if (inputEvent.vMousePosition != m_LastPolledMouse.vMousePosition || inputEvent.bLeftButton != m_LastPolledMouse.bLeftButton
+        || inputEvent.bRightButton != m_LastPolledMouse.bRightButton) {
+        bAnyInput = true;
+    }
+    m_LastPolledMouse = inputEvent;
+
+    if (bAnyInput) {
+        {
+            std::lock_guard<std::mutex> lock(m_InputMutex);
+            m_bInputSeen = true;
+        }
+        m_InputSeen.notify_one();
+    }
+    return bAnyInput;
+}
+
+void Game::QueueInput(const InputEvent& rEvent) {
+    std::lock_guard<std::mutex> lock(m_InputMutex);
+    m_PendingInputEvents.push_back(rEvent);
+}
+
+bool Game::HandleInput() {
+    {
+        // Take everything queued since the last tick, the render thread starts filling the other list
+        std::lock_guard<std::mutex> lock(m_InputMutex);
+        m_InputEvents.swap(m_PendingInputEvents);
+    }
+
+    m_eScrollWheelInput = None;
+    bool bChanged = false;
+    for (const InputEvent& inputEvent : m_InputEvents) {
+        if (inputEvent.eType != InputEvent::Mouse || inputEvent.vMousePosition != m_vMousePosition
+            || inputEvent.bLeftButton != m_bLeftMouseDown || inputEvent.bRightButton != m_bRightMouseDown) {
+            bChanged = true;
+        }
+
+        switch (inputEvent.eType) {
+        case InputEvent::ToggleMode:
+            if (m_eGameMode == Play) {
+                CaptureSnapshot(m_PausedMatch);
+                m_eGameMode = LevelEditor;
+            } else {
+                m_EditHistory.EndStroke();
+                // If the layout was edited the snapshot won't match, and the match starts over
+                m_eGameMode = Play;
+                RestoreSnapshot(m_PausedMatch);
+            }
+            break;
+        case InputEvent::Scroll:
+            m_eScrollWheelInput = inputEvent.eScroll;
+            break;
+        case InputEvent::Mouse:
+            m_vMousePosition = inputEvent.vMousePosition;
+            m_bLeftMouseDown = inputEvent.bLeftButton;
+            m_bRightMouseDown = inputEvent.bRightButton;
+            break;
+        case InputEvent::Undo:
+            if (m_eGameMode == LevelEditor) UndoEdit();
+            break;
+        case InputEvent::Redo:
+            if (m_eGameMode == LevelEditor) RedoEdit();
+            break;
+        case InputEvent::SwitchTower:
+            m_bPlaceSplashTower = !m_bPlaceSplashTower;
+            break;
+        }
+    }
+    m_InputEvents.clear();
+
+    switch (m_eGameMode) {
+        case Play:
+            HandlePlayInput();
+            break;
+        case LevelEditor:
+            HandleLevelEditorInput();
+            break;
+    }
+    return bChanged;
+}
+
+void Game::CreateTileAtPosition(const sf::Vector2f& pos) {
+    int x = pos.x / 160;
+    int y = pos.y / 160;
+
+    TileOptions::TileType eTileType = m_TileOptions[m_optionIndex].getTileType();
+    if (eTileType == TileOptions::TileType::Null) return;
+
+    // Painting over a tile replaces it where it is in the list
+    if (SetTileAt(eTileType, sf::Vector2i(x, y), m_optionIndex) && eTileType != TileOptions::TileType::Aesthetic) {
+        ConstructionPath();
+    }
+}
+
+void Game::DeleteTileAtPosition(const sf::Vector2f& pos) {
+    int x = pos.x / 160;
+    int y = pos.y / 160;
+
+    TileOptions::TileType eTileType = m_TileOptions[m_optionIndex].getTileType();
+    if (eTileType == TileOptions::TileType::Null) return;
+
+    if (SetTileAt(eTileType, sf::Vector2i(x, y), -1) && eTileType != TileOptions::TileType::Aesthetic) {
+        ConstructionPath();
+    }
+}
+
+bool Game::SetTileAt(TileOptions::TileType eTileType, const sf::Vector2i& vCell, int iNewOption) {
+    if (vCell.x < 0 || vCell.y < 0) return false; // Off the map
+    vector<Entity>& ListOfTiles = GetListOfTiles(eTileType);
+    const int iTileCount = static_cast<int>(ListOfTiles.size());
+
+    EditHistory::TileEdit edit;
+    edit.iTileType = static_cast<int8_t>(eTileType);
+    edit.iOldOption = -1;
+    edit.iNewOption = static_cast<int8_t>(iNewOption);
+    edit.iCellX = static_cast<int16_t>(vCell.x);
+    edit.iCellY = static_cast<int16_t>(vCell.y);
+    edit.iListIndex = iTileCount; // New tiles go on the end
+    edit.iMovedIndex = -1;
+
+    const int iExisting = m_TileIndices[eTileType].Get(vCell);
+    if (iExisting >= 0) {
+        edit.iListIndex = iExisting;
+        edit.iOldOption = static_cast<int8_t>(GetTileOption(ListOfTiles[iExisting]));
+        if (iNewOption < 0 && iExisting != iTileCount - 1) {
+            edit.iMovedIndex = iTileCount - 1;
+        }
+    }
+
+    // Holding the mouse over a tile that is already painted changes nothing
+    if (edit.iOldOption == edit.iNewOption) return false;
+
+    ApplyTileEdit(edit, false);
+    m_EditHistory.Record(edit);
+    return true;
+}
+
+void Game::ApplyTileEdit(const EditHistory::TileEdit& rEdit, bool bUndo) {
+    const TileOptions::TileType eTileType = static_cast<TileOptions::TileType>(rEdit.iTileType);
+    vector<Entity>& ListOfTiles = GetListOfTiles(eTileType);
+
+    const int iFromOption = bUndo ? rEdit.iNewOption : rEdit.iOldOption;
+    const int iToOption = bUndo ? rEdit.iOldOption : rEdit.iNewOption;
+    const sf::Vector2i vCell(rEdit.iCellX, rEdit.iCellY);
+    CellIndexMap& rTileIndices = m_TileIndices[eTileType];
+    const int iTileCount = static_cast<int>(ListOfTiles.size());
+
+    // Edits are replayed in exactly the reverse order they were made, so the list always looks
+    // the way it did when the edit was logged and the swaps below undo each other
+    if (iToOption < 0) {
+        // The last tile fills the hole, nothing else has to shift
+        assert(rEdit.iMovedIndex == (rEdit.iListIndex == iTileCount - 1 ? -1 : iTileCount - 1));
+        rTileIndices.Set(vCell, -1);
+        if (rEdit.iMovedIndex >= 0) {
+            ListOfTiles[rEdit.iListIndex] = ListOfTiles[rEdit.iMovedIndex];
+            rTileIndices.Set(ListOfTiles[rEdit.iListIndex].GetClosestGridCoordinates(), rEdit.iListIndex);
+        }
+        ListOfTiles.pop_back();
+    } else {
+        Entity tile(m_TilePrototypes[iToOption]);
+        tile.SetPosition(sf::Vector2f(vCell.x * 160 + 80, vCell.y * 160 + 80));
+        if (iFromOption < 0) {
+            // Putting a removed tile back sends the one that filled its hole back to the end
+            if (rEdit.iMovedIndex >= 0) {
+                assert(rEdit.iMovedIndex == iTileCount);
+                const Entity movedTile = ListOfTiles[rEdit.iListIndex];
+                ListOfTiles.push_back(movedTile);
+                rTileIndices.Set(movedTile.GetClosestGridCoordinates(), rEdit.iMovedIndex);
+                ListOfTiles[rEdit.iListIndex] = tile;
+            } else {
+                assert(rEdit.iListIndex == iTileCount);
+                ListOfTiles.push_back(tile);
+            }
+            rTileIndices.Set(vCell, rEdit.iListIndex);
+        } else {
+            ListOfTiles[rEdit.iListIndex] = tile;
+        }
+    }
+
+    m_bWallsOutOfDate = true;
+    if (eTileType == TileOptions::TileType::Aesthetic) {
+        m_PlacementMap.SetBuildable(vCell, iToOption >= 0 && IsBrickTile(ListOfTiles[rEdit.iListIndex]));
+    }
+}
+
+void Game::UndoEdit() {
+    const EditHistory::TileEdit* pBegin;
+    const EditHistory::TileEdit* pEnd;
+    if (!m_EditHistory.Undo(pBegin, pEnd)) return;
+
+    // Newest first, and routes are rebuilt once for the whole stroke
+    bool bRoutesChanged = false;
+    for (const EditHistory::TileEdit* pEdit = pEnd; pEdit != pBegin; ) {
+        --pEdit;
+        ApplyTileEdit(*pEdit, true);
+        bRoutesChanged |= pEdit -> iTileType != TileOptions::TileType::Aesthetic;
+    }
+    if (bRoutesChanged) {
+        ConstructionPath();
+    }
+}
+
+void Game::RedoEdit() {
+    const EditHistory::TileEdit* pBegin;
+    const EditHistory::TileEdit* pEnd;
+    if (!m_EditHistory.Redo(pBegin, pEnd)) return;
+
+    bool bRoutesChanged = false;
+    for (const EditHistory::TileEdit* pEdit = pBegin; pEdit != pEnd; ++pEdit) {
+        ApplyTileEdit(*pEdit, false);
+        bRoutesChanged |= pEdit -> iTileType != TileOptions::TileType::Aesthetic;
+    }
+    if (bRoutesChanged) {
+        ConstructionPath();
+    }
+}
+
+void Game::ConstructionPath() {
+    vector<sf::Vector2i> WalkableCells;
+    vector<sf::Vector2i> SpawnCells;
+    vector<sf::Vector2i> ExitCells;
+
+    for (const Entity& tile : m_SpawnTiles) {
+        SpawnCells.push_back(tile.GetClosestGridCoordinates());
+        WalkableCells.push_back(tile.GetClosestGridCoordinates());
+    }
+    for (const Entity& tile : m_EndTiles) {
+        ExitCells.push_back(tile.GetClosestGridCoordinates());
+        WalkableCells.push_back(tile.GetClosestGridCoordinates());
+    }
+    for (const Entity& tile : m_PathTiles) {
+        WalkableCells.push_back(tile.GetClosestGridCoordinates());
+    }
+
+    m_RouteMap.Build(WalkableCells, SpawnCells, ExitCells);
+    // Waypoints kept from the old routes may lead somewhere else now
+    for (Entity& enemy : m_enemies) {
+        enemy.m_iSteeredCell = -1;
+    }
+}
+
+void Game::BuildWalls() {
+    // Tiles under a spawn, exit or path stay open, everything else enemies bump into
+    vector<sf::Vector2i> WalkableCells;
+    for (const vector<Entity>* pTiles : { &m_SpawnTiles, &m_EndTiles, &m_PathTiles }) {
+        for (const Entity& tile : *pTiles) {
+            WalkableCells.push_back(tile.GetClosestGridCoordinates());
+        }
+    }
+    auto CellOrder = [](const sf::Vector2i& a, const sf::Vector2i& b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    };
+    std::sort(WalkableCells.begin(), WalkableCells.end(), CellOrder);
+
+    vector<sf::Vector2i> BlockedCells;
+    for (const Entity& tile : m_AestheticTiles) {
+        const sf::Vector2i vCell = tile.GetClosestGridCoordinates();
+        if (!std::binary_search(WalkableCells.begin(), WalkableCells.end(), vCell, CellOrder)) {
+            BlockedCells.push_back(vCell);
+        }
+    }
+
+    m_WallMap.Build(BlockedCells);
+    m_bWallsOutOfDate = false;
+}
+
+void Game::DrawLevelEditor(const RenderSnapshot& rSnapshot) {
+    // Only the render thread touches the options' sprites, the simulation just reads their types
+	TileOptions& rTileOption = m_TileOptions[rSnapshot.iTileOption];
+	rTileOption.setPosition(rSnapshot.vMousePosition);
+
+    for (const RenderSnapshot::Item& item : rSnapshot.RouteTiles) {
+        item.Draw(m_Window);
+    }
+	m_Window.draw(rTileOption);
+}
+
+void Game::HandlePlayInput() {
+    // Right clicking a tower switches what it aims at
+    if (m_bRightMouseDown && !m_bRightMouseDownLastUpdate) {
+        if (Entity* pTower = FindTowerAt(m_vMousePosition)) {
+            const int iNextMode = (static_cast<int>(pTower -> m_eTargetingMode) + 1) % static_cast<int>(Entity::TargetingMode::NumModes);
+            pTower -> m_eTargetingMode = static_cast<Entity::TargetingMode>(iNextMode);
+        }
+    }
+    m_bRightMouseDownLastUpdate = m_bRightMouseDown;
+
+    if (m_bLeftMouseDown) {
+        const int iCost = m_bPlaceSplashTower ? SplashTowerCost : TowerCost;
+        if (m_iPlayerGold >= iCost) {
+            if (CreateTowerAtPosition(m_vMousePosition, m_bPlaceSplashTower)) {
+                m_iPlayerGold -= iCost;
+            }
+        }
+    }
+}
+
+void Game::HandleLevelEditorInput() {
+
+    if (m_eScrollWheelInput == ScrollUp) {
+        m_optionIndex++;
+        if (m_optionIndex >= m_TileOptions.size()) {
+            m_optionIndex = 0;
+        }
+    }
+    else if (m_eScrollWheelInput == ScrollDown) {
+        m_optionIndex--;
+        if (m_optionIndex < 0) {
+            m_optionIndex = m_TileOptions.size() - 1;
+        }
+    }
+
+    // Everything painted while a button is held is undone together
+    const bool bPainting = m_bLeftMouseDown || m_bRightMouseDown;
+    if (bPainting) {
+        m_EditHistory.BeginStroke();
+    } else {
+        m_EditHistory.EndStroke();
+    }
+
+    if (m_bLeftMouseDown) {
+        CreateTileAtPosition(m_vMousePosition);
+    }
+
+    if (m_bRightMouseDown) {
+        DeleteTileAtPosition(m_vMousePosition);
+    }
+}
+
+vector<Entity>& Game::GetListOfTiles(TileOptions::TileType eTileType) {
+    switch (eTileType) {
+        case TileOptions::TileType::Aesthetic:
+            return m_AestheticTiles;
+        case TileOptions::TileType::Spawn:
+            return m_SpawnTiles;
+        case TileOptions::TileType::End:
+            return m_EndTiles;
+        case TileOptions::TileType::Path:
+            return m_PathTiles;
+	}
+	return m_AestheticTiles; // Default return if no match found
+}
+
+int Game::GetTileOption(const Entity& tile) const {
+    // Tiles point at the prototype of the option they were painted with
+    return static_cast<int>(&tile.GetPrototype() - m_TilePrototypes.data());
+}
+
+bool Game::CreateTowerAtPosition(const sf::Vector2f& pos, bool bSplash) {
+    if (CanPlaceTowerAtPosition(pos)) {
+        Entity newTower = m_TowerTemplate;
+        newTower.SetPosition(pos);
+        newTower.SetColor(bSplash ? SplashColor : sf::Color::White);
+        newTower.m_fSplashRadius = bSplash ? SplashRadius : 0.0f;
+        // The first throw comes one reload after it is built
+        newTower.m_iTimerDueTick = m_TowerTimers.GetNow() + TowerReloadTicks;
+        newTower.m_iTimerHandle = m_TowerTimers.Schedule(newTower.m_iTimerDueTick, static_cast<int>(m_Towers.size()));
+        m_Towers.push_back(newTower);
+        m_PlacementMap.AddTower(pos);
+        return true;
+    }
+    return false;
+}
+
+bool Game::CanPlaceTowerAtPosition(const sf::Vector2f& pos) {
+    // Towers go on brick tiles, and can't overlap another tower
+    if (!m_PlacementMap.IsBuildable(pos)) {
+        return false;
+	}
+
+    const float fTowerRadius = m_TowerPrototype.m_PhysicsData.m_fRadius;
+    return !m_PlacementMap.OverlapsTower(pos, fTowerRadius * 2);
+}
+
+bool Game::IsBrickTile(const Entity& tile) const {
+    const sf::IntRect brickRect(0, 0, 16, 16);
+    return tile.GetPrototype().m_Sprite.getTextureRect() == brickRect;
+}
+
+void Game::AddGold(int gold) {
+    m_iPlayerGold += gold;
+    m_iGoldGainedThisUpdate += gold;
+    m_iGoldEarned += gold;
+}
+
+void Game::RunStressTest(const StressSettings& rSettings) {
+    m_StressSettings = rSettings;
+    m_StressSettings.bEnabled = true;
+    m_StressReport.Reset();
+    m_iPhysicsDivergences = 0;
+    m_StressReport.SetEntityFootprint(sizeof(Entity), sizeof(Entity::Prototype));
+
+    if (m_SpawnTiles.empty() || m_EndTiles.empty()) {
+        BuildLaneLevel();
+    }
+    if (m_Towers.empty()) {
+        PlaceTowersAlongRoute(m_StressSettings.iTowers, m_StressSettings.iSplashTowers);
+    }
+
+    if (!m_StressSettings.snapshotLoadPath.empty()) {
+        SimulationSnapshot snapshot;
+        if (snapshot.LoadFromFile(m_StressSettings.snapshotLoadPath) && RestoreSnapshot(snapshot)) {
+            cout << "Resumed from " << m_StressSettings.snapshotLoadPath << " with " << m_enemies.size() << " enemies\n";
+        } else {
+            cout << "Couldn't resume from " << m_StressSettings.snapshotLoadPath << ", starting fresh\n";
+        }
+    }
+    SimulationSnapshot tickSnapshot;
+
+    // An entity copy allocates nothing, so storage growth is the only allocation a spawn can cause
+    size_t iEnemyCapacity = m_enemies.capacity();
+    size_t iAxeCapacity = m_axes.capacity();
+
+    for (int iTick = 0; iTick < m_StressSettings.iMaxTicks; iTick++) {
+        m_deltaTime = sf::seconds(m_StressSettings.fTickSeconds);
+        m_FrameArena.Reset();
+        UpdatePlay();
+
+        if (m_enemies.capacity() != iEnemyCapacity) {
+            iEnemyCapacity = m_enemies.capacity();
+            m_StressReport.AddStorageReallocation();
+        }
+        if (m_axes.capacity() != iAxeCapacity) {
+            iAxeCapacity = m_axes.capacity();
+            m_StressReport.AddStorageReallocation();
+        }
+
+        if (m_StressSettings.bSnapshotEveryTick || iTick == m_StressSettings.iSnapshotSaveTick) {
+            sf::Clock snapshotClock;
+            CaptureSnapshot(tickSnapshot);
+            m_StressReport.AddPhaseTime(StressReport::Snapshot, snapshotClock.getElapsedTime());
+        }
+        if (iTick == m_StressSettings.iSnapshotSaveTick && !m_StressSettings.snapshotSavePath.empty()) {
+            tickSnapshot.SaveToFile(m_StressSettings.snapshotSavePath);
+        }
+
+        const std::size_t iEntityBytes = (m_enemies.capacity() + m_axes.capacity() + m_Towers.capacity()) * sizeof(Entity);
+        m_StressReport.EndTick(m_enemies.size(), m_axes.size(), m_Towers.size(), iEntityBytes);
+
+        if (m_StressSettings.iReportEveryTicks > 0 && m_StressReport.GetTickCount() % m_StressSettings.iReportEveryTicks == 0) {
+            m_StressReport.PrintProgress(cout);
+        }
+
+        // Done once the whole budget has been spawned and has left the map
+        if (m_iEnemiesSpawned >= m_StressSettings.iSpawnBudget && m_enemies.empty()) {
+            break;
+        }
+    }
+    if (m_StressSettings.iSnapshotSaveTick < 0 && !m_StressSettings.snapshotSavePath.empty()) {
+        CaptureSnapshot(tickSnapshot);
+        tickSnapshot.SaveToFile(m_StressSettings.snapshotSavePath);
+    }
+    if (!tickSnapshot.IsEmpty()) {
+        cout << "Last snapshot: " << tickSnapshot.GetSize() / 1024 << " KB\n";
+    }
+    m_StressReport.SetSpawnCount(m_iEnemiesSpawned + m_iAxesThrown);
+    m_StressReport.SetFrameArenaUsage(m_FrameArena.GetPeakBytes(), m_FrameArena.GetOverflowCount());
+    m_StressReport.Print(cout);
+    if (m_StressSettings.bValidatePhysics) {
+        cout << "Physics updates that diverged from the reference: " << m_iPhysicsDivergences << "\n";
+    }
+    if (AllocationTracker::IsEnabled()) {
+        AllocationTracker::WriteScopeReport(cout);
+    }
+}
+
+bool Game::RunAllocationCheck(const AllocationCheckSettings& rSettings) {
+    if (!AllocationTracker::IsEnabled()) {
+        cout << "Allocation tracking is off, build with TRACK_ALLOCATIONS defined to run the check\n";
+        return false;
+    }
+
+    if (m_SpawnTiles.empty() || m_EndTiles.empty()) {
+        BuildLaneLevel();
+    }
+    if (m_Towers.empty()) {
+        PlaceTowersAlongRoute(rSettings.iTowers, 0);
+    }
+
+    // Rounded, 120 s at 1/60 s is a hair under 7200 ticks in floats
+    const int iWarmupTicks = static_cast<int>(std::lround(rSettings.fWarmupSeconds / rSettings.fTickSeconds));
+    const int iMeasuredTicks = static_cast<int>(std::lround(rSettings.fMeasuredSeconds / rSettings.fTickSeconds));
+    AllocationTracker::Counts measured;
+    uint64_t iWorstTickAllocations = 0;
+    int iWorstTick = -1;
+    int iTicksOverBudget = 0;
+
+    for (int iTick = 0; iTick < iWarmupTicks + iMeasuredTicks; iTick++) {
+        if (iTick == iWarmupTicks) {
+            AllocationTracker::ResetScopes();
+        }
+
+        // A whole tick as the simulation thread runs it, render snapshot included
+        const AllocationTracker::Counts before = AllocationTracker::GetThreadCounts();
+        m_deltaTime = sf::seconds(rSettings.fTickSeconds);
+        m_FrameArena.Reset();
+        UpdatePlay();
+        WriteSnapshot(m_Snapshots.GetWriteBuffer());
+        m_Snapshots.Publish();
+        const AllocationTracker::Counts tick = AllocationTracker::GetThreadCounts().Since(before);
+
+        if (iTick < iWarmupTicks) continue;
+        measured.iAllocations += tick.iAllocations;
+        measured.iBytes += tick.iBytes;
+        measured.iFrees += tick.iFrees;
+        if (tick.iAllocations > iWorstTickAllocations) {
+            iWorstTickAllocations = tick.iAllocations;
+            iWorstTick = iTick;
+        }
+        if (tick.iAllocations > static_cast<uint64_t>(rSettings.iBudgetPerTick)) {
+            iTicksOverBudget++;
+        }
+    }
+
+    cout << "Allocation check over " << iMeasuredTicks << " ticks, after " << iWarmupTicks << " warm-up ticks\n";
+    cout << "  enemies at the end: " << m_enemies.size() << ", axes: " << m_axes.size() << "\n";
+    cout << "  allocations: " << measured.iAllocations << " (" << measured.iBytes / 1024 << " KB), frees: " << measured.iFrees << "\n";
+    cout << "  worst tick: " << iWorstTickAllocations << " allocations";
+    if (iWorstTick >= 0) cout << " on tick " << iWorstTick;
+    cout << "\n";
+    cout << "  ticks over the budget of " << rSettings.iBudgetPerTick << ": " << iTicksOverBudget << "\n";
+    AllocationTracker::WriteScopeReport(cout);
+    cout << (iTicksOverBudget == 0 ? "PASS" : "FAIL") << "\n";
+    return iTicksOverBudget == 0;
+}
+
+bool Game::RunPhysicsCheck(const PhysicsCheckSettings& rSettings) {
+    const int iMaxReportedWorlds = 10;
+    int iUpdates = 0;
+    int iDivergedWorlds = 0;
+
+    for (int iWorld = 0; iWorld < rSettings.iWorlds; iWorld++) {
+        const unsigned int uWorldSeed = rSettings.uSeed + iWorld;
+        std::mt19937 rng(uWorldSeed);
+        auto Random = [&rng](float fMin, float fMax) {
+            return std::uniform_real_distribution<float>(fMin, fMax)(rng);
+        };
+        auto RandomInt = [&rng](int iMin, int iMax) {
+            return std::uniform_int_distribution<int>(iMin, iMax)(rng);
+        };
+
+        // A small level for the walls, then bodies dropped anywhere on it, walls included
+        LevelGenerator::Settings levelSettings;
+        levelSettings.eStyle = static_cast<LevelGenerator::Style>(RandomInt(0, LevelGenerator::NumStyles - 1));
+        levelSettings.iColumns = RandomInt(8, 20);
+        levelSettings.iRows = RandomInt(6, 14);
+        levelSettings.uSeed = rng();
+        levelSettings.iLanes = RandomInt(1, 3);
+        LoadGeneratedLevel(LevelGenerator::Generate(levelSettings));
+        const sf::Vector2f vLevelSize(levelSettings.iColumns * 160.0f, levelSettings.iRows * 160.0f);
+        auto RandomPosition = [&]() {
+            return sf::Vector2f(Random(-80.0f, vLevelSize.x + 80.0f), Random(-80.0f, vLevelSize.y + 80.0f));
+        };
+
+        const int iTowers = RandomInt(0, 6);
+        for (int i = 0; i < iTowers; i++) {
+            m_Towers.emplace_back(m_TowerPrototype).SetPosition(RandomPosition());
+        }
+
+        const int iEnemies = RandomInt(0, 60);
+        for (int i = 0; i < iEnemies; i++) {
+            Entity& enemy = m_enemies.emplace_back(m_EnemyPrototype);
+            // Some are dropped into a crowd, or exactly on top of the one before
+            const int iPlacement = RandomInt(0, 9);
+            if (iPlacement == 0 && i > 0) {
+                enemy.SetPosition(m_enemies[i - 1].GetPosition());
+            } else if (iPlacement < 4 && i > 0) {
+                enemy.SetPosition(m_enemies[i - 1].GetPosition() + sf::Vector2f(Random(-60.0f, 60.0f), Random(-60.0f, 60.0f)));
+            } else {
+                enemy.SetPosition(RandomPosition());
+            }
+            enemy.SetVelocity(sf::Vector2f(Random(-250.0f, 250.0f), Random(-250.0f, 250.0f)));
+            enemy.AddImpulse(sf::Vector2f(Random(-20.0f, 20.0f), Random(-20.0f, 20.0f)));
+        }
+
+        const int iAxes = RandomInt(0, 30);
+        for (int i = 0; i < iAxes; i++) {
+            Entity& axe = m_axes.emplace_back(m_AxePrototype);
+            axe.SetPosition(RandomPosition());
+            // Up to several times the real speed, so the sub-steps and the swept test both get used
+            const float fAngle = Random(0.0f, 6.2831853f);
+            axe.SetVelocity(sf::Vector2f(std::cos(fAngle), std::sin(fAngle)) * AxeSpeed * Random(0.0f, 4.0f));
+            if (RandomInt(0, 3) == 0) axe.m_fSplashRadius = SplashRadius;
+        }
+
+        for (int iUpdate = 0; iUpdate < rSettings.iUpdatesPerWorld; iUpdate++) {
+            // Past the cap sometimes, physics clamps long frames
+            m_deltaTime = sf::seconds(Random(1.0f / 240.0f, 0.15f));
+            m_FrameArena.Reset();
+            m_DamageEvents.Clear();
+            const string divergence = UpdatePhysicsValidated(rSettings.fTolerance);
+            iUpdates++;
+            if (divergence.empty()) continue;
+
+            if (iDivergedWorlds < iMaxReportedWorlds) {
+                cout << "World " << iWorld << " (seed " << uWorldSeed << "), update " << iUpdate << ": " << divergence << "\n";
+            }
+            iDivergedWorlds++;
+            break;
+        }
+    }
+    m_DamageEvents.Clear();
+
+    cout << "Physics check over " << rSettings.iWorlds << " worlds, " << iUpdates << " updates compared\n";
+    cout << "  worlds that diverged: " << iDivergedWorlds << "\n";
+    cout << (iDivergedWorlds == 0 ? "PASS" : "FAIL") << "\n";
+    return iDivergedWorlds == 0;
+}
+
+namespace {
+    void AppendEntityStates(SimulationSnapshot& rSnapshot, const vector<Entity>& rEntities) {
+        unsigned char* pStates = static_cast<unsigned char*>(rSnapshot.Extend(rEntities.size() * sizeof(Entity::State)));
+        for (const Entity& entity : rEntities) {
+            const Entity::State state = entity.GetState();
+            memcpy(pStates, &state, sizeof(state));
+            pStates += sizeof(state);
+        }
+    }
+
+    bool ReadEntityStates(const SimulationSnapshot& rSnapshot, size_t& rOffset, uint32_t uCount, vector<Entity>& rEntities, const Entity& rBlank) {
+        const unsigned char* pStates = static_cast<const unsigned char*>(rSnapshot.Read(rOffset, uCount * sizeof(Entity::State)));
+        if (!pStates) return false;
+
+        rEntities.assign(uCount, rBlank);
+        for (Entity& entity : rEntities) {
+            Entity::State state;
+            memcpy(&state, pStates, sizeof(state));
+            entity.SetState(state);
+            pStates += sizeof(state);
+        }
+        return true;
+    }
+}
+
+void Game::CaptureSnapshot(SimulationSnapshot& rSnapshot) const {
+    const vector<DamageTextManager::DamageText>& rDamageTexts = m_DamageTextManager.GetDamageTexts();
+
+    // Zeroed first so the padding is the same in every snapshot, and saved files compare equal
+    SimulationSnapshot::Header header;
+    memset(static_cast<void*>(&header), 0, sizeof(header));
+    header.uMagic = SimulationSnapshot::Magic;
+    header.uVersion = SimulationSnapshot::Version;
+    header.uHeaderSize = sizeof(SimulationSnapshot::Header);
+    header.uEntityStateSize = sizeof(Entity::State);
+    header.uLayoutHash = ComputeLayoutHash();
+    header.uTowerCount = static_cast<uint32_t>(m_Towers.size());
+    header.uEnemyCount = static_cast<uint32_t>(m_enemies.size());
+    header.uAxeCount = static_cast<uint32_t>(m_axes.size());
+    header.uDamageTextCount = static_cast<uint32_t>(rDamageTexts.size());
+
+    header.iPlayerHealth = m_iPlayerHealth;
+    header.iPlayerGold = m_iPlayerGold;
+    header.iGoldGainedThisUpdate = m_iGoldGainedThisUpdate;
+    header.fTimeInPlayMode = m_fTimeInPlayMode;
+    header.fDifficulty = m_fDifficulty;
+    header.fGoldPerSecond = m_fGoldPerSecond;
+    header.fGoldPerSecondTimer = m_fGoldPerSecondTimer;
+    header.fSpawnTimer = m_fSpawnTimer;
+    header.iEnemiesSpawned = m_iEnemiesSpawned;
+    header.iAxesThrown = m_iAxesThrown;
+    header.iEnemiesKilled = m_iEnemiesKilled;
+    header.iEnemiesLeaked = m_iEnemiesLeaked;
+    header.iGoldEarned = m_iGoldEarned;
+    header.iTimerTick = m_TowerTimers.GetNow();
+    header.fTimerRemainder = m_fTimerRemainder;
+    header.iSteeringCursor = m_Lod.GetCursor(LodScheduler::Steering);
+    header.iAxeSpinCursor = m_Lod.GetCursor(LodScheduler::AxeSpin);
+    header.rng = m_Rng;
+
+    rSnapshot.Clear();
+    rSnapshot.Append(&header, sizeof(header));
+    AppendEntityStates(rSnapshot, m_Towers);
+    AppendEntityStates(rSnapshot, m_enemies);
+    AppendEntityStates(rSnapshot, m_axes);
+    rSnapshot.Append(rDamageTexts.data(), rDamageTexts.size() * sizeof(DamageTextManager::DamageText));
+}
+
+bool Game::RestoreSnapshot(const SimulationSnapshot& rSnapshot) {
+    size_t iOffset = 0;
+    const void* pHeader = rSnapshot.Read(iOffset, sizeof(SimulationSnapshot::Header));
+    if (!pHeader) return false;
+
+    SimulationSnapshot::Header header;
+    memcpy(&header, pHeader, sizeof(header));
+    if (header.uMagic != SimulationSnapshot::Magic || header.uVersion != SimulationSnapshot::Version
+        || header.uHeaderSize != sizeof(SimulationSnapshot::Header) || header.uEntityStateSize != sizeof(Entity::State)) {
+        return false;
+    }
+    if (header.uLayoutHash != ComputeLayoutHash()) return false;
+
+    const size_t iExpectedSize = sizeof(header)
+        + (static_cast<size_t>(header.uTowerCount) + header.uEnemyCount + header.uAxeCount) * sizeof(Entity::State)
+        + header.uDamageTextCount * sizeof(DamageTextManager::DamageText);
+    if (rSnapshot.GetSize() != iExpectedSize) return false;
+
+    // Sizes are checked, nothing below can fail part way
+    ReadEntityStates(rSnapshot, iOffset, header.uTowerCount, m_Towers, m_TowerTemplate);
+    ReadEntityStates(rSnapshot, iOffset, header.uEnemyCount, m_enemies, Entity(m_EnemyPrototype));
+    ReadEntityStates(rSnapshot, iOffset, header.uAxeCount, m_axes, Entity(m_AxePrototype));
+
+    const DamageTextManager::DamageText* pDamageTexts = static_cast<const DamageTextManager::DamageText*>(
+        rSnapshot.Read(iOffset, header.uDamageTextCount * sizeof(DamageTextManager::DamageText)));
+    m_DamageTextManager.SetDamageTexts(pDamageTexts, header.uDamageTextCount);
+
+    m_PlacementMap.ClearTowers();
+    for (const Entity& tower : m_Towers) {
+        m_PlacementMap.AddTower(tower.GetPosition());
+    }
+
+    m_iPlayerHealth = header.iPlayerHealth;
+    m_iPlayerGold = header.iPlayerGold;
+    m_iGoldGainedThisUpdate = header.iGoldGainedThisUpdate;
+    m_fTimeInPlayMode = header.fTimeInPlayMode;
+    m_fDifficulty = header.fDifficulty;
+    m_fGoldPerSecond = header.fGoldPerSecond;
+    m_fGoldPerSecondTimer = header.fGoldPerSecondTimer;
+    m_fSpawnTimer = header.fSpawnTimer;
+    m_iEnemiesSpawned = header.iEnemiesSpawned;
+    m_iAxesThrown = header.iAxesThrown;
+    m_iEnemiesKilled = header.iEnemiesKilled;
+    m_iEnemiesLeaked = header.iEnemiesLeaked;
+    m_iGoldEarned = header.iGoldEarned;
+    m_Rng = header.rng;
+
+    // Handles don't survive a snapshot, the due ticks do
+    ResetTimers(header.iTimerTick);
+    m_fTimerRemainder = header.fTimerRemainder;
+    RescheduleTimers();
+    m_Lod.SetCursor(LodScheduler::Steering, header.iSteeringCursor);
+    m_Lod.SetCursor(LodScheduler::AxeSpin, header.iAxeSpinCursor);
+    return true;
+}
+
+uint64_t Game::ComputeLayoutHash() const {
+    // Each tile hashes on its own and the results are summed, so the order tiles were painted in doesn't matter
+    uint64_t uHash = 0;
+    const vector<Entity>* pTileLists[] = { &m_AestheticTiles, &m_SpawnTiles, &m_EndTiles, &m_PathTiles };
+    for (int iList = 0; iList < 4; iList++) {
+        for (const Entity& tile : *pTileLists[iList]) {
+            const sf::Vector2i vCell = tile.GetClosestGridCoordinates();
+            const uint64_t uPrototype = static_cast<uint64_t>(GetTileOption(tile));
+
+            uint64_t uTileHash = 1469598103934665603ull;
+            const uint64_t uParts[] = { static_cast<uint64_t>(iList), uPrototype, static_cast<uint64_t>(vCell.x), static_cast<uint64_t>(vCell.y) };
+            for (uint64_t uPart : uParts) {
+                uTileHash = (uTileHash ^ uPart) * 1099511628211ull;
+            }
+            uHash += uTileHash;
+        }
+    }
+    return uHash;
+}
+
+void Game::BuildLaneLevel() {
+    // One straight lane across the middle of the screen, with bricks everywhere else
+    LevelGenerator::Settings settings;
+    settings.eStyle = LevelGenerator::Lane;
+    settings.iColumns = LaneLevelColumns;
+    settings.iRows = LaneLevelRows;
+    LoadGeneratedLevel(LevelGenerator::Generate(settings));
+}
+
+void Game::LoadGeneratedLevel(const LevelGenerator::Level& rLevel) {
+    for (const Entity& tile : m_AestheticTiles) {
+        m_PlacementMap.SetBuildable(tile.GetClosestGridCoordinates(), false);
+    }
+    m_AestheticTiles.clear();
+    m_SpawnTiles.clear();
+    m_EndTiles.clear();
+    m_PathTiles.clear();
+    for (CellIndexMap& rTileIndices : m_TileIndices) {
+        rTileIndices.Clear();
+    }
+
+    m_Towers.clear();
+    m_enemies.clear();
+    m_axes.clear();
+    m_PlacementMap.ClearTowers();
+    ResetTimers(0);
+    m_EditHistory.Clear();
+
+    const int iBrickOption = 0;
+    const int iSpawnOption = 4;
+    const int iEndOption = 5;
+    const int iPathOption = 6;
+
+    // Straight into the lists, painting each tile would search the list and rebuild the routes every time
+    for (int y = 0; y < rLevel.iRows; y++) {
+        for (int x = 0; x < rLevel.iColumns; x++) {
+            const sf::Vector2f vTileCenter(x * 160 + 80, y * 160 + 80);
+            m_AestheticTiles.emplace_back(m_TilePrototypes[iBrickOption]).SetPosition(vTileCenter);
+            m_TileIndices[TileOptions::Aesthetic].Set(sf::Vector2i(x, y), static_cast<int>(m_AestheticTiles.size()) - 1);
+            m_PlacementMap.SetBuildable(sf::Vector2i(x, y), true);
+
+            switch (rLevel.GetCell(x, y)) {
+            case LevelGenerator::Spawn:
+                m_SpawnTiles.emplace_back(m_TilePrototypes[iSpawnOption]).SetPosition(vTileCenter);
+                m_TileIndices[TileOptions::Spawn].Set(sf::Vector2i(x, y), static_cast<int>(m_SpawnTiles.size()) - 1);
+                break;
+            case LevelGenerator::Exit:
+                m_EndTiles.emplace_back(m_TilePrototypes[iEndOption]).SetPosition(vTileCenter);
+                m_TileIndices[TileOptions::End].Set(sf::Vector2i(x, y), static_cast<int>(m_EndTiles.size()) - 1);
+                break;
+            case LevelGenerator::Path:
+                m_PathTiles.emplace_back(m_TilePrototypes[iPathOption]).SetPosition(vTileCenter);
+                m_TileIndices[TileOptions::Path].Set(sf::Vector2i(x, y), static_cast<int>(m_PathTiles.size()) - 1);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    ConstructionPath();
+    m_bWallsOutOfDate = true;
+}
+
+void Game::PlaceTowersAlongRoute(int iTowers, int iSplashTowers) {
+    struct Site {
+        int iDistance; // Steps from the path tile beside it to the nearest exit
+        sf::Vector2i vCell;
+    };
+    vector<Site> Sites;
+
+    const sf::Vector2i Neighbours[4] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+    for (const Entity& tile : m_PathTiles) {
+        const sf::Vector2i vPathCell = tile.GetClosestGridCoordinates();
+        int iDistance = -1;
+        for (int iExit = 0; iExit < m_RouteMap.GetExitCount(); iExit++) {
+            const int iExitDistance = m_RouteMap.GetDistance(iExit, vPathCell);
+            if (iExitDistance >= 0 && (iDistance < 0 || iExitDistance < iDistance)) iDistance = iExitDistance;
+        }
+        if (iDistance < 0) continue; // Enemies never come this way
+
+        for (const sf::Vector2i& vOffset : Neighbours) {
+            const sf::Vector2i vCell = vPathCell + vOffset;
+            if (!m_RouteMap.IsWalkable(vCell)) Sites.push_back({ iDistance, vCell });
+        }
+    }
+
+    // Furthest from the exits first, row by row where that ties, so a lane is lined from the spawn end.
+    // A brick beside several path tiles goes where it is furthest along.
+    sort(Sites.begin(), Sites.end(), [](const Site& a, const Site& b) {
+        if (a.iDistance != b.iDistance) return a.iDistance > b.iDistance;
+        return a.vCell.y < b.vCell.y || (a.vCell.y == b.vCell.y && a.vCell.x < b.vCell.x);
+    });
+
+    int iTowersPlaced = 0;
+    for (int i = 0; i < static_cast<int>(Sites.size()) && iTowersPlaced < iTowers; i++) {
+        const bool bSplash = iTowersPlaced < iSplashTowers;
+        if (CreateTowerAtPosition(sf::Vector2f(Sites[i].vCell.x * 160 + 80, Sites[i].vCell.y * 160 + 80), bSplash)) {
+            iTowersPlaced++;
+        }
+    }
+}
+
+Game::MatchResult Game::SimulateMatch(const vector<sf::Vector2f>& rTowerPositions, float fSimulatedSeconds, float fTickSeconds) {
+    if (m_SpawnTiles.empty() || m_EndTiles.empty()) {
+        BuildLaneLevel();
+    }
+
+    MatchResult result;
+    result.iTowersPlaced = 0;
+    for (const sf::Vector2f& vTowerPosition : rTowerPositions) {
+        if (CreateTowerAtPosition(vTowerPosition)) {
+            result.iTowersPlaced++;
+        }
+    }
+
+    // Leaks don't cost health in play yet, so count the time until they would have ended the match
+    const int iStartingHealth = m_iPlayerHealth;
+    result.bSurvived = true;
+    result.fSurvivedSeconds = fSimulatedSeconds;
+
+    const int iTicks = static_cast<int>(fSimulatedSeconds / fTickSeconds);
+    for (int iTick = 0; iTick < iTicks; iTick++) {
+        m_deltaTime = sf::seconds(fTickSeconds);
+        m_FrameArena.Reset();
+        UpdatePlay();
+
+        if (result.bSurvived && m_iEnemiesLeaked >= iStartingHealth) {
+            result.bSurvived = false;
+            result.fSurvivedSeconds = m_fTimeInPlayMode;
+        }
+    }
+
+    result.iEnemiesSpawned = m_iEnemiesSpawned;
+    result.iEnemiesKilled = m_iEnemiesKilled;
+    result.iEnemiesLeaked = m_iEnemiesLeaked;
+    result.iGoldEarned = m_iGoldEarned;
+    result.iFinalGold = m_iPlayerGold;
+    return result;
 }
\ No newline at end of file
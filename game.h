@@ -1,120 +1,411 @@
-#pragma once
-#include <SFML/Graphics.hpp>
-#include "Entity.h"
-#include "TileOptions.h"
-#include <vector>
-#include <string>
-#include <iostream>
-using namespace std;
-
-class Game {
-public:
-	Game();
-	~Game();
-
-	enum GameMode {
-		Play,
-		LevelEditor
-	};
-
-	//Scroll wheel values
-	enum ScrollWheel {
-		ScrollUp,
-		ScrollDown,
-		None
-	};
-
-	struct PathTile {
-		const Entity* pCurrentTile;
-		const Entity* pNextTile;
-	};
-
-	void run();
-private:
-	void UpdatePlay();
-	void UpdateTower();
-	void UpdateAxe();
-	void CheckForDeletionRequest();
-	void UpdateLevelEditor();
-
-	void UpdatePhysics();
-private:
-	void ProcessCollision(Entity &entity1, Entity &entity2);
-	bool isColiding(const Entity& entity1, const Entity& entity2);
-public:
-	void Draw();
-	void DrawPlay();
-	void DrawLevelEditor();
-
-	void HandlePlayInput();
-	void HandleLevelEditorInput();
-	void HandleInput();
-
-	//Level Editor functions
-	void CreateTileAtPosition(const sf::Vector2f& pos) ;
-	void DeleteTileAtPosition(const sf::Vector2f& pos);
-	void ConstructionPath();
-	vector<Entity>& GetListOfTiles(TileOptions::TileType eTileType);
-
-	// Play functions
-	bool CreateTowerAtPosition(const sf::Vector2f& pos);
-	bool CanPlaceTowerAtPosition(const sf::Vector2f& pos);
-
-	void AddGold(int gold);
-private:
-	sf::RenderWindow m_Window;
-	sf::Time m_deltaTime;
-	GameMode m_eGameMode;
-
-	//Play mode
-	sf::Texture towerTexture;
-	sf::Texture enemyTexture;
-	sf::Texture axeTexture;
-
-	Entity m_TowerTemplate;
-	vector <Entity> m_Towers;
-
-	Entity m_enemyTemplate;
-	vector<Entity> m_enemies;
-
-	Entity m_axeTemplate;
-	vector<Entity> m_axes;
-
-	//vector <Entity*> m_AllEntities;
-
-	sf::Text m_GameModeText;
-	sf::Font m_Font;
-	sf::Text m_PlayerText;
-	sf::Text m_GameOverText;
-
-	//Level Editor Mode
-	int m_optionIndex;
-	ScrollWheel m_eScrollWheelInput;
-
-	sf::Texture m_TileMapTexture;
-	// TODO: these need to be entities, not sprites
-	vector <TileOptions> m_TileOptions;
-	vector <Entity> m_AestheticTiles;
-	vector <Entity> m_SpawnTiles;
-	vector <Entity> m_EndTiles;
-	vector <Entity> m_PathTiles;
-
-	bool m_bDrawPath;
-
-	//GamePlay variables
-	int m_iPlayerHealth;
-	int m_iPlayerGold;
-	int m_iGoldGainedThisUpdate;
-	float m_fTimeInPlayMode;
-	float m_fDifficulty;
-	float m_fGoldPerSecond;
-	float m_fGoldPerSecondTimer;
-private:
-	//PathFinding
-	typedef vector<PathTile> Path;
-
-	void VisitPathNeighbors(Path path, const sf::Vector2i& rEndCoords);
-	bool DoesPathContainCoordinates(const Path& path, const sf::Vector2i& coordinates);
-
-	vector<Path> m_Paths;
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Entity.h"
+#include "TileOptions.h"
+#include "StressReport.h"
+#include "SpatialGrid.h"
+#include "Narrowphase.h"
+#include "DamageEvents.h"
+#include "DamageTextManager.h"
+#include "PlacementMap.h"
+#include "FrameArena.h"
+#include "RouteMap.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
+#include "MetricsRegistry.h"
+#include "SimulationSnapshot.h"
+#include "EditHistory.h"
+#include "CellIndexMap.h"
+#include "WallMap.h"
+#include "PathProgressIndex.h"
+#include "TimerWheel.h"
+#include "LodScheduler.h"
+#include "FramePacer.h"
+#include "LevelGenerator.h"
+#include "PhysicsTrace.h"
+#include <vector>
+#include <string>
+#include <iostream>
+#include <unordered_set>
+#include <utility>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+using namespace std;
+
+class Game {
+public:
+	// A headless game opens no window and loads no textures or fonts.
+	// Each game has its own random numbers, so games with the same seed play out the same.
+	Game(bool bHeadless = false, unsigned int uSeed = std::random_device()());
+	~Game();
+
+	enum GameMode {
+		Play,
+		LevelEditor
+	};
+
+	//Scroll wheel values
+	enum ScrollWheel {
+		ScrollUp,
+		ScrollDown,
+		None
+	};
+
+	// Input seen by the render thread, queued up for the simulation thread
+	struct InputEvent {
+		enum Type {
+			ToggleMode,
+			Scroll,
+			Mouse,
+			Undo,
+			Redo,
+			SwitchTower
+		};
+		Type eType;
+		ScrollWheel eScroll;
+		sf::Vector2f vMousePosition;
+		bool bLeftButton;
+		bool bRightButton;
+	};
+
+	// Settings for pushing a large crowd through the update pipeline
+	struct StressSettings {
+		bool bEnabled = false;
+		int iSpawnBudget = 100000; // Total number of enemies spawned over the run
+		int iMaxEntities = 100000; // Ceiling on live enemies and axes together
+		float fStartSpawnRate = 20.0f; // Enemies per second at the start of the run
+		float fSpawnRateRamp = 20.0f; // Enemies per second added every second
+		float fMaxSpawnRate = 5000.0f;
+		int iTowers = 16;
+		int iSplashTowers = 0; // How many of the towers throw splash axes
+		float fTickSeconds = 1.0f / 60.0f;
+		int iMaxTicks = 36000;
+		int iReportEveryTicks = 60;
+		bool bSnapshotEveryTick = false; // Capture the whole match every tick, to time it
+		string snapshotLoadPath; // Start from a saved match instead of an empty one
+		string snapshotSavePath;
+		int iSnapshotSaveTick = -1; // Tick to save on, or the end of the run when negative
+		bool bValidatePhysics = false; // Check every physics update against the reference, several times slower
+	};
+
+	// A scripted headless match that watches the heap once the match has settled
+	struct AllocationCheckSettings {
+		float fWarmupSeconds = 120.0f; // Not measured, storage grows to fit the largest crowd here
+		float fMeasuredSeconds = 120.0f;
+		int iBudgetPerTick = 0; // Most allocations any measured tick may make
+		int iTowers = 16;
+		float fTickSeconds = 1.0f / 60.0f;
+	};
+
+	// Random worlds put through the optimized physics and the reference side by side
+	struct PhysicsCheckSettings {
+		int iWorlds = 2000;
+		unsigned int uSeed = 1; // World i is built from uSeed + i, so a failing world can be run again alone
+		int iUpdatesPerWorld = 4;
+		float fTolerance = 0.01f; // How far apart the two runs may leave a body, in world units
+	};
+
+	// What happened in one headless match
+	struct MatchResult {
+		int iTowersPlaced;
+		bool bSurvived;
+		float fSurvivedSeconds;
+		int iEnemiesSpawned;
+		int iEnemiesKilled;
+		int iEnemiesLeaked;
+		int iGoldEarned;
+		int iFinalGold;
+	};
+
+	// Size of the level BuildLaneLevel() makes, in tiles
+	static constexpr int LaneLevelColumns = 16;
+	static constexpr int LaneLevelRows = 10;
+
+	// Simulates on a thread of its own while this thread polls the window and draws snapshots
+	void run();
+	void RunStressTest(const StressSettings& rSettings);
+	// False if any measured tick went over budget, or the build can't count allocations
+	bool RunAllocationCheck(const AllocationCheckSettings& rSettings);
+	// False if any world came out of the two physics implementations differently
+	bool RunPhysicsCheck(const PhysicsCheckSettings& rSettings);
+	// The running match as flat bytes, cheap enough to take every tick.
+	// Restoring fails and leaves the game alone if the snapshot is from another version or level.
+	void CaptureSnapshot(SimulationSnapshot& rSnapshot) const;
+	bool RestoreSnapshot(const SimulationSnapshot& rSnapshot);
+
+	// Live counters for dashboards, safe to read from any thread
+	const MetricsRegistry& GetMetrics() const { return m_Metrics.registry; }
+
+	// Updates per tick for low priority work, 0 or less turns the slicing off for that class
+	void SetLodBudget(LodScheduler::Class eClass, int iUpdatesPerTick) { m_Lod.SetBudget(eClass, iUpdatesPerTick); }
+	// Replaces the tiles with a generated level, dropping the match and the undo history.
+	// Call before run() or RunStressTest().
+	void LoadGeneratedLevel(const LevelGenerator::Level& rLevel);
+
+	// Frames per second the window is held to, 0 or less runs unpaced. Set before run().
+	void SetFrameRate(float fFramesPerSecond) { m_fFrameRate = fFramesPerSecond; }
+
+	// Places the towers and plays a headless match at a fixed tick, on the lane level if none is loaded
+	MatchResult SimulateMatch(const vector<sf::Vector2f>& rTowerPositions, float fSimulatedSeconds, float fTickSeconds);
+private:
+	void UpdatePlay();
+	void UpdateSpawning();
+	void SpawnEnemy();
+	int GetLiveEntityCount() const;
+	void BuildLaneLevel();
+	// Puts towers on the bricks beside the path, starting from the spawn end of the route
+	void PlaceTowersAlongRoute(int iTowers, int iSplashTowers);
+	// Moves the timer wheels on by whole ticks and hands out whatever came due
+	void UpdateTimers();
+	// Clears both wheels and restarts them at iNow, with nothing scheduled
+	void ResetTimers(int iNow);
+	// Files every tower and axe under its due tick again, after the wheels were reset
+	void RescheduleTimers();
+	// Where a thrown axe could still land, the bounds of every tower grown by an axe's range.
+	// Empty with no towers.
+	sf::FloatRect GetTowerReach() const;
+	void UpdateTower();
+	// Index into m_enemies of what this tower should throw at, there has to be at least one enemy
+	int FindTarget(const Entity& rTower);
+	// Needs an up to date m_EnemyGrid
+	int FindClosestEnemy(const sf::Vector2f& vPosition);
+	Entity* FindTowerAt(const sf::Vector2f& vPosition);
+	void UpdateAxe();
+	void ApplyDamageEvents();
+	void CheckForDeletionRequest();
+	void UpdateLevelEditor();
+
+	// Indexes enemies where they are right now, for neighbour and overlap queries
+	void BuildEnemyGrid();
+	void UpdateCrowdSeparation();
+	void UpdatePhysics();
+	// Every body against every other and every wall, with none of the culling UpdatePhysics() does
+	// and shape tests and push-outs of its own instead of Narrowphase's, so both get checked.
+	// Far too slow to play on, kept as the answer the optimized path is checked against.
+	void UpdatePhysicsReference();
+	// Runs both from the same state and keeps what UpdatePhysics() did.
+	// Returns the first place the reference disagreed, empty when it didn't.
+	string UpdatePhysicsValidated(float fTolerance);
+	// Position of a body in the order physics walks them, towers then enemies then axes
+	int GetPhysicsId(const Entity& entity) const;
+	void TracePhysicsBodies(PhysicsTrace& rTrace) const;
+private:
+	void ProcessCollision(Entity &entity1, Entity &entity2, const Narrowphase::Contact& contact);
+	bool isColiding(const Entity& entity1, const Entity& entity2);
+	bool isSweptColiding(const Entity& entity1, const sf::Vector2f& vPreviousPosition, const Entity& entity2);
+	int GetSubStepCount(const Entity& entity, const sf::Vector2f& vMovement) const;
+public:
+	// Simulation thread
+	void RunSimulation();
+	void WriteSnapshot(RenderSnapshot& rSnapshot);
+	// Sleeps until the render thread sees input, or the timeout runs out
+	void WaitForInput(const sf::Time& timeout);
+
+	// Render thread
+	void Draw(const RenderSnapshot& rSnapshot);
+	void DrawPlay(const RenderSnapshot& rSnapshot);
+	void DrawLevelEditor(const RenderSnapshot& rSnapshot);
+	// True when anything came from the window, or the mouse moved or clicked
+	bool PollWindowInput();
+	void QueueInput(const InputEvent& rEvent);
+
+	// Simulation thread, applies the queued input
+	void HandlePlayInput();
+	void HandleLevelEditorInput();
+	// True when any of the input could change what is drawn
+	bool HandleInput();
+
+	//Level Editor functions
+	void CreateTileAtPosition(const sf::Vector2f& pos) ;
+	void DeleteTileAtPosition(const sf::Vector2f& pos);
+	void ConstructionPath();
+	void BuildWalls();
+	vector<Entity>& GetListOfTiles(TileOptions::TileType eTileType);
+	int GetTileOption(const Entity& tile) const;
+
+	// Puts a tile option (or nothing, with -1) in a cell of one tile list, and logs it for undo.
+	// False if the cell already held that, routes are left for the caller to rebuild.
+	bool SetTileAt(TileOptions::TileType eTileType, const sf::Vector2i& vCell, int iNewOption);
+	void ApplyTileEdit(const EditHistory::TileEdit& rEdit, bool bUndo);
+	void UndoEdit();
+	void RedoEdit();
+
+	// Play functions
+	bool CreateTowerAtPosition(const sf::Vector2f& pos, bool bSplash = false);
+	bool CanPlaceTowerAtPosition(const sf::Vector2f& pos);
+	bool IsBrickTile(const Entity& tile) const;
+
+	void AddGold(int gold);
+private:
+	sf::RenderWindow m_Window;
+	sf::Time m_deltaTime;
+	GameMode m_eGameMode;
+
+	//Play mode
+	sf::Texture towerTexture;
+	sf::Texture enemyTexture;
+	sf::Texture axeTexture;
+
+	Entity::Prototype m_TowerPrototype;
+	Entity m_TowerTemplate; // Placement preview that follows the mouse
+	vector <Entity> m_Towers;
+
+	Entity::Prototype m_EnemyPrototype;
+	vector<Entity> m_enemies;
+	SpatialGrid m_EnemyGrid;
+	float m_fLargestEnemyRadius; // Widest reach a grid query has to allow for
+	// Enemies by distance left to their exit, for the tower targeting modes
+	PathProgressIndex m_ProgressIndex;
+
+	Entity::Prototype m_AxePrototype;
+	vector<Entity> m_axes;
+
+	// Tower reloads and axe lifetimes, payloads are indices into m_Towers and m_axes.
+	// Only what comes due gets touched, idle towers and flying axes cost nothing per tick.
+	TimerWheel m_TowerTimers;
+	TimerWheel m_AxeTimers;
+	float m_fTimerRemainder; // Time not yet worth a whole timer tick
+	vector<int> m_ReadyTowers; // Reloaded towers waiting for something to throw at
+	vector<int> m_ExpiredTimers;
+
+	// Enemies and axes off screen and away from the towers only get some of their updates each tick
+	LodScheduler m_Lod;
+	sf::FloatRect m_ScreenBounds; // Empty when headless, nothing is ever on screen
+
+	// Pairs that already had OnCollision called this update, stored lowest address first
+	typedef pair<const Entity*, const Entity*> CollisionPair;
+	struct CollisionPairHash {
+		size_t operator()(const CollisionPair& rPair) const {
+			return hash<const Entity*>()(rPair.first) ^ (hash<const Entity*>()(rPair.second) * 31);
+		}
+	};
+	typedef unordered_set<CollisionPair, CollisionPairHash, equal_to<CollisionPair>, FrameAllocator<CollisionPair>> CollisionPairSet;
+	static CollisionPair MakeCollisionPair(const Entity& entity1, const Entity& entity2);
+
+	// Hits from this tick's physics, applied together by ApplyDamageEvents
+	DamageEventBuffer m_DamageEvents;
+	// Filled in by the physics update while it is being validated, null the rest of the time
+	PhysicsTrace* m_pPhysicsTrace;
+	int m_iPhysicsDivergences;
+
+	//vector <Entity*> m_AllEntities;
+
+	sf::Text m_GameModeText;
+	sf::Font m_Font;
+	sf::Text m_PlayerText;
+	sf::Text m_GameOverText;
+
+	//Level Editor Mode
+	int m_optionIndex;
+	ScrollWheel m_eScrollWheelInput;
+
+	sf::Texture m_TileMapTexture;
+	// TODO: these need to be entities, not sprites
+	vector <TileOptions> m_TileOptions;
+	vector <Entity::Prototype> m_TilePrototypes; // One per tile option, placed tiles point at these
+	vector <Entity> m_AestheticTiles;
+	vector <Entity> m_SpawnTiles;
+	vector <Entity> m_EndTiles;
+	vector <Entity> m_PathTiles;
+	// Where each cell's tile sits in its list, one map per TileType
+	CellIndexMap m_TileIndices[TileOptions::NumTileTypes];
+
+	// Distances from every walkable tile to every exit, rebuilt whenever the layout changes
+	RouteMap m_RouteMap;
+
+	// Brick cells and placed towers, for constant time placement checks
+	PlacementMap m_PlacementMap;
+
+	// Brick cells that aren't under a path, merged into rectangles enemies collide with.
+	// Rebuilt before the next physics update whenever a tile changes.
+	WallMap m_WallMap;
+	bool m_bWallsOutOfDate;
+
+	bool m_bDrawPath;
+	EditHistory m_EditHistory;
+
+	//GamePlay variables
+	int m_iPlayerHealth;
+	int m_iPlayerGold;
+	int m_iGoldGainedThisUpdate;
+	float m_fTimeInPlayMode;
+	float m_fDifficulty;
+	float m_fGoldPerSecond;
+	float m_fGoldPerSecondTimer;
+	float m_fSpawnTimer;
+
+	//Stress mode
+	bool m_bHeadless;
+	StressSettings m_StressSettings;
+	StressReport m_StressReport;
+	int m_iEnemiesSpawned;
+	int m_iAxesThrown;
+	int m_iEnemiesKilled;
+	int m_iEnemiesLeaked;
+	int m_iGoldEarned;
+
+	bool m_bTwasPressedLastUpdate;
+	GameMode m_eDrawnGameMode;
+	float m_fFrameRate;
+	InputEvent m_LastPolledMouse; // Render thread, to tell a still mouse from a moving one
+
+	// Bumped every tick that could have changed the picture, so the render thread can tell
+	// when the editor or the game over screen is still showing what it drew last
+	unsigned int m_uSceneRevision;
+
+	// Handed from the render thread to the simulation thread, swapped under the lock once a tick
+	std::mutex m_InputMutex;
+	vector<InputEvent> m_PendingInputEvents;
+	// Set under the lock when the render thread saw input, wakes a simulation waiting in WaitForInput()
+	bool m_bInputSeen;
+	std::condition_variable m_InputSeen;
+	vector<InputEvent> m_InputEvents;
+
+	// Latest mouse state the simulation has been told about
+	sf::Vector2f m_vMousePosition;
+	bool m_bLeftMouseDown;
+	bool m_bRightMouseDown;
+	bool m_bRightMouseDownLastUpdate;
+	bool m_bPlaceSplashTower; // What a left click in play mode builds
+
+	TripleBuffer<RenderSnapshot> m_Snapshots;
+
+	// Everything published to the metrics registry, updated once per play tick
+	struct Metrics {
+		Metrics();
+		MetricsRegistry registry;
+		MetricsRegistry::Counter& rTicks;
+		MetricsRegistry::Gauge& rLiveEnemies;
+		MetricsRegistry::Gauge& rLiveAxes;
+		MetricsRegistry::Gauge& rTowers;
+		MetricsRegistry::Gauge& rRoutedSpawns;
+		MetricsRegistry::Gauge& rExits;
+		MetricsRegistry::Counter& rPairsTested;
+		MetricsRegistry::Counter& rCollisionsResolved;
+		MetricsRegistry::Gauge& rFrameArenaBytes;
+		MetricsRegistry::Gauge& rFrameArenaOverflows;
+		MetricsRegistry::Counter& rStorageGrowths;
+		MetricsRegistry::Gauge& rGoldPerSecond;
+		MetricsRegistry::Histogram& rTickSeconds;
+		MetricsRegistry::Counter& rLodDeferred;
+		MetricsRegistry::Counter& rFramesPresented;
+		MetricsRegistry::Counter& rFramesSkipped;
+		MetricsRegistry::Gauge& rFrameJitter;
+	};
+	Metrics m_Metrics;
+	void PublishMetrics(const sf::Time& tickTime, size_t iEnemyCapacity, size_t iAxeCapacity);
+
+	// Identifies the tile layout, so snapshots are only restored onto the level they came from
+	uint64_t ComputeLayoutHash() const;
+	// The match that was running when the level editor was opened, picked up again on leaving it
+	SimulationSnapshot m_PausedMatch;
+	std::atomic<bool> m_bSimulationRunning;
+	std::mt19937 m_Rng;
+	DamageTextManager m_DamageTextManager;
+
+	// Scratch memory for the current tick, reset before each one
+	FrameArena m_FrameArena;
 };
\ No newline at end of file
@@ -1,7 +1,170 @@
-﻿#include "game.h"
-int main() {
-    Game game;
-    game.run();
-
-    return 0;
+﻿#include "game.h"
+#include "BatchRunner.h"
+#include "MetricsServer.h"
+#include "MathBenchmark.h"
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    Game::StressSettings stressSettings;
+    int iBatchMatches = 0;
+    int iBatchTowers = 8;
+    int iBatchThreads = 0;
+    float fBatchSeconds = 120.0f;
+    int iMetricsPort = 0;
+    bool bMathCheck = false;
+    int iSteeringBudget = -1; // Left at the default when negative
+    int iAxeSpinBudget = -1;
+    float fFrameRate = 60.0f;
+    LevelGenerator::Settings levelSettings;
+    bool bGenerateLevel = false;
+    bool bAllocationCheck = false;
+    Game::AllocationCheckSettings allocationCheckSettings;
+    Game::PhysicsCheckSettings physicsCheckSettings;
+    bool bPhysicsCheck = false;
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        const bool bHasValue = i + 1 < argc;
+        if (arg == "--stress") {
+            stressSettings.bEnabled = true;
+        } else if (arg == "--stress-budget" && bHasValue) {
+            stressSettings.iSpawnBudget = atoi(argv[++i]);
+        } else if (arg == "--stress-ceiling" && bHasValue) {
+            stressSettings.iMaxEntities = atoi(argv[++i]);
+        } else if (arg == "--stress-towers" && bHasValue) {
+            stressSettings.iTowers = atoi(argv[++i]);
+        } else if (arg == "--stress-splash-towers" && bHasValue) {
+            stressSettings.iSplashTowers = atoi(argv[++i]);
+        } else if (arg == "--stress-ticks" && bHasValue) {
+            stressSettings.iMaxTicks = atoi(argv[++i]);
+        } else if (arg == "--stress-snapshot-every-tick") {
+            stressSettings.bSnapshotEveryTick = true;
+        } else if (arg == "--stress-load" && bHasValue) {
+            stressSettings.snapshotLoadPath = argv[++i];
+        } else if (arg == "--stress-save" && bHasValue) {
+            stressSettings.snapshotSavePath = argv[++i];
+        } else if (arg == "--stress-save-tick" && bHasValue) {
+            stressSettings.iSnapshotSaveTick = atoi(argv[++i]);
+        } else if (arg == "--stress-validate-physics") {
+            stressSettings.bValidatePhysics = true;
+        } else if (arg == "--batch" && bHasValue) {
+            iBatchMatches = atoi(argv[++i]);
+        } else if (arg == "--batch-towers" && bHasValue) {
+            iBatchTowers = atoi(argv[++i]);
+        } else if (arg == "--batch-threads" && bHasValue) {
+            iBatchThreads = atoi(argv[++i]);
+        } else if (arg == "--batch-seconds" && bHasValue) {
+            fBatchSeconds = static_cast<float>(atof(argv[++i]));
+        } else if (arg == "--metrics-port" && bHasValue) {
+            iMetricsPort = atoi(argv[++i]);
+        } else if (arg == "--lod-steering-budget" && bHasValue) {
+            iSteeringBudget = atoi(argv[++i]);
+        } else if (arg == "--lod-spin-budget" && bHasValue) {
+            iAxeSpinBudget = atoi(argv[++i]);
+        } else if (arg == "--fps" && bHasValue) {
+            fFrameRate = static_cast<float>(atof(argv[++i]));
+        } else if (arg == "--level" && bHasValue) {
+            if (LevelGenerator::FindStyle(argv[++i], levelSettings.eStyle)) {
+                bGenerateLevel = true;
+            } else {
+                cout << "Unknown level style " << argv[i] << "\n";
+            }
+        } else if (arg == "--level-size" && bHasValue) {
+            // Columns x rows, such as 64x40
+            char* pRows = nullptr;
+            levelSettings.iColumns = static_cast<int>(strtol(argv[++i], &pRows, 10));
+            if (*pRows == 'x') levelSettings.iRows = atoi(pRows + 1);
+        } else if (arg == "--level-seed" && bHasValue) {
+            levelSettings.uSeed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--level-lanes" && bHasValue) {
+            levelSettings.iLanes = atoi(argv[++i]);
+        } else if (arg == "--alloc-check") {
+            bAllocationCheck = true;
+        } else if (arg == "--alloc-budget" && bHasValue) {
+            allocationCheckSettings.iBudgetPerTick = atoi(argv[++i]);
+        } else if (arg == "--alloc-warmup" && bHasValue) {
+            allocationCheckSettings.fWarmupSeconds = static_cast<float>(atof(argv[++i]));
+        } else if (arg == "--alloc-seconds" && bHasValue) {
+            allocationCheckSettings.fMeasuredSeconds = static_cast<float>(atof(argv[++i]));
+        } else if (arg == "--physics-check" && bHasValue) {
+            bPhysicsCheck = true;
+            physicsCheckSettings.iWorlds = atoi(argv[++i]);
+        } else if (arg == "--physics-seed" && bHasValue) {
+            physicsCheckSettings.uSeed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--physics-updates" && bHasValue) {
+            physicsCheckSettings.iUpdatesPerWorld = atoi(argv[++i]);
+        } else if (arg == "--physics-tolerance" && bHasValue) {
+            physicsCheckSettings.fTolerance = static_cast<float>(atof(argv[++i]));
+        } else if (arg == "--math-check") {
+            bMathCheck = true;
+        }
+    }
+
+    if (bMathCheck) {
+        MathBenchmark benchmark(1 << 16, 1);
+        const bool bAccurate = benchmark.CheckAccuracy(cout);
+        benchmark.Run(200, cout);
+        return bAccurate ? 0 : 1;
+    }
+
+    if (iBatchMatches > 0) {
+        BatchRunner runner(fBatchSeconds, 1.0f / 60.0f);
+        const vector<BatchRunner::Job> jobs = BatchRunner::MakeRandomJobs(iBatchMatches, iBatchTowers, 1);
+        BatchRunner::PrintSummary(runner.Run(jobs, iBatchThreads), cout);
+        return 0;
+    }
+
+    // Scrape http://127.0.0.1:<port>/ while the game or a stress run is going
+    auto startMetricsServer = [&](MetricsServer& rServer) {
+        if (iMetricsPort <= 0) return;
+        if (rServer.Start(static_cast<unsigned short>(iMetricsPort))) {
+            cout << "Serving metrics on 127.0.0.1:" << iMetricsPort << "\n";
+        } else {
+            cout << "Couldn't open metrics port " << iMetricsPort << "\n";
+        }
+    };
+
+    auto applyLodBudgets = [&](Game& rGame) {
+        if (iSteeringBudget >= 0) rGame.SetLodBudget(LodScheduler::Steering, iSteeringBudget);
+        if (iAxeSpinBudget >= 0) rGame.SetLodBudget(LodScheduler::AxeSpin, iAxeSpinBudget);
+    };
+
+    auto loadLevel = [&](Game& rGame) {
+        if (!bGenerateLevel) return;
+        sf::Clock clock;
+        const LevelGenerator::Level level = LevelGenerator::Generate(levelSettings);
+        rGame.LoadGeneratedLevel(level);
+        cout << "Generated level: " << LevelGenerator::GetStyleName(levelSettings.eStyle) << ", " << level.iColumns << "x" << level.iRows
+            << " from seed " << levelSettings.uSeed << ", routed in " << clock.getElapsedTime().asMicroseconds() / 1000.0 << " ms\n";
+    };
+
+    if (bAllocationCheck) {
+        Game game(true);
+        loadLevel(game);
+        return game.RunAllocationCheck(allocationCheckSettings) ? 0 : 1;
+    }
+
+    if (bPhysicsCheck) {
+        Game game(true);
+        return game.RunPhysicsCheck(physicsCheckSettings) ? 0 : 1;
+    }
+
+    if (stressSettings.bEnabled) {
+        Game game(true);
+        applyLodBudgets(game);
+        loadLevel(game);
+        MetricsServer metricsServer(game.GetMetrics());
+        startMetricsServer(metricsServer);
+        game.RunStressTest(stressSettings);
+        return 0;
+    }
+
+    Game game;
+    applyLodBudgets(game);
+    loadLevel(game);
+    game.SetFrameRate(fFrameRate);
+    MetricsServer metricsServer(game.GetMetrics());
+    startMetricsServer(metricsServer);
+    game.run();
+
+    return 0;
 }
\ No newline at end of file